@@ -21,6 +21,8 @@
 #include <io/IO_device.h>
 #include "pcd8544.h"
 
+#include <string.h>
+
 //------------------------------------------------------------------------------
 // Initialization sequence
 //------------------------------------------------------------------------------
@@ -42,6 +44,18 @@ static const uint8_t cursor_rst_seq[] = {
   0x80,  // x cursor to 0
 };
 
+//------------------------------------------------------------------------------
+// Extend the modified span of a page
+//------------------------------------------------------------------------------
+static void mark_dirty(pcd8544 *device, uint8_t page, uint8_t first,
+  uint8_t last)
+{
+  if(first < device->dirty[page][0])
+    device->dirty[page][0] = first;
+  if(last > device->dirty[page][1])
+    device->dirty[page][1] = last;
+}
+
 //------------------------------------------------------------------------------
 // Initialize the device
 //------------------------------------------------------------------------------
@@ -80,6 +94,12 @@ int32_t PCD8544_init(pcd8544 *device, uint8_t ssi_module, uint8_t dc_pin,
   IO_sync(&device->ssi);
   IO_set(&device->dc, 1);
 
+  //----------------------------------------------------------------------------
+  // The display RAM holds garbage, so the first sync writes everything
+  //----------------------------------------------------------------------------
+  for(int i = 0; i < 6; ++i)
+    mark_dirty(device, i, 0, 84);
+
   return 0;
 }
 
@@ -99,9 +119,11 @@ int32_t PCD8544_get_attrs(IO_display_attrs *attrs)
 //------------------------------------------------------------------------------
 int32_t PCD8544_clear(pcd8544 *device)
 {
-  for(int i = 0; i < 6; ++i)
+  for(int i = 0; i < 6; ++i) {
     for(int j = 0; j < 84; ++j)
       device->pixels[i][j] = 0;
+    mark_dirty(device, i, 0, 84);
+  }
   return 0;
 }
 
@@ -128,6 +150,276 @@ int32_t PCD8544_put_pixel(pcd8544 *device, uint16_t x, uint16_t y,
   else
     device->pixels[ybyte][x] &= ~byte;
 
+  mark_dirty(device, ybyte, x, x+1);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Get the color of a pixel
+//------------------------------------------------------------------------------
+int32_t PCD8544_get_pixel(pcd8544 *device, uint16_t x, uint16_t y,
+  uint32_t *argb)
+{
+  if(x > 83 || y > 47)
+    return -IO_EINVAL;
+
+  if(device->pixels[y/8][x] & (1 << (y%8)))
+    *argb = 0;
+  else
+    *argb = 0xffffffff;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Describe the pixel matrix as a framebuffer
+//------------------------------------------------------------------------------
+int32_t PCD8544_get_framebuffer(pcd8544 *device, IO_framebuffer *fb)
+{
+  fb->pixels = &device->pixels[0][0];
+  fb->stride = 84;
+  fb->width  = 84;
+  fb->height = 48;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Mark a rectangle modified behind the driver's back
+//------------------------------------------------------------------------------
+int32_t PCD8544_mark_dirty(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  if(x > 83 || y > 47 || !width || !height)
+    return -IO_EINVAL;
+
+  uint16_t last = x + width > 84 ? 84 : x + width;
+  uint16_t end  = y + height > 48 ? 48 : y + height;
+  for(int p = y/8; p <= (end-1)/8; ++p)
+    mark_dirty(device, p, x, last);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Blit a box of packed columns through an optional mask of the same layout
+//------------------------------------------------------------------------------
+static int32_t blit(pcd8544 *device, uint16_t x, uint16_t y, uint16_t width,
+  uint16_t height, const uint8_t *data, const uint8_t *mask)
+{
+  if(x > 83 || y > 47)
+    return -IO_EINVAL;
+
+  uint8_t pages  = (height + 7) / 8;
+  uint8_t ybyte  = y / 8;
+  uint8_t ybit   = y % 8;
+  uint16_t cols  = width;
+  if(x + cols > 84)
+    cols = 84 - x;
+
+  //----------------------------------------------------------------------------
+  // Every source byte spans at most two pages of the display, so shift it
+  // into a 16-bit window and merge both halves under a mask
+  //----------------------------------------------------------------------------
+  for(int p = 0; p < pages && ybyte + p < 6; ++p) {
+    uint8_t rows = height - p*8;
+    uint16_t rmask = rows >= 8 ? 0xff : (1 << rows) - 1;
+    rmask <<= ybit;
+
+    uint8_t *lo = &device->pixels[ybyte+p][x];
+    uint8_t *hi = ybyte + p + 1 < 6 ? &device->pixels[ybyte+p+1][x] : 0;
+    const uint8_t *src = data + p;
+    const uint8_t *msk = mask ? mask + p : 0;
+
+    mark_dirty(device, ybyte+p, x, x+cols);
+    if(hi && ybit)
+      mark_dirty(device, ybyte+p+1, x, x+cols);
+
+    for(int i = 0; i < cols; ++i, src += pages) {
+      uint16_t m = rmask;
+      if(msk) {
+        m &= *msk << ybit;
+        msk += pages;
+      }
+      uint16_t bits = (*src << ybit) & m;
+      lo[i] = (lo[i] & ~m) | bits;
+      if(hi)
+        hi[i] = (hi[i] & ~(m >> 8)) | (bits >> 8);
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Blit a box of packed columns
+//------------------------------------------------------------------------------
+int32_t PCD8544_blit(pcd8544 *device, uint16_t x, uint16_t y, uint16_t width,
+  uint16_t height, const uint8_t *data)
+{
+  return blit(device, x, y, width, height, data, 0);
+}
+
+//------------------------------------------------------------------------------
+// Blit a bitmap through a mask
+//------------------------------------------------------------------------------
+int32_t PCD8544_blit_masked(pcd8544 *device, uint16_t x, uint16_t y,
+  const IO_bitmap *bitmap, const IO_bitmap *mask)
+{
+  return blit(device, x, y, bitmap->width, bitmap->height, bitmap->data,
+              mask ? mask->data : 0);
+}
+
+//------------------------------------------------------------------------------
+// Apply an operation to a box of pixels
+//------------------------------------------------------------------------------
+#define RECT_SET    0
+#define RECT_CLEAR  1
+#define RECT_INVERT 2
+
+static int32_t rect_op(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, uint8_t op)
+{
+  if(x > 83 || y > 47)
+    return -IO_EINVAL;
+
+  uint16_t x1 = x + width  > 84 ? 84 : x + width;
+  uint16_t y1 = y + height > 48 ? 48 : y + height;
+  if(x1 == x || y1 == y)
+    return 0;
+  uint16_t cols = x1 - x;
+
+  //----------------------------------------------------------------------------
+  // Every page is handled at once for all the rows of the rectangle it
+  // contains; full pages are set or cleared with memset
+  //----------------------------------------------------------------------------
+  for(int p = y/8; p <= (y1-1)/8; ++p) {
+    uint8_t top    = y > p*8 ? y - p*8 : 0;
+    uint8_t bottom = y1 < p*8+8 ? y1 - p*8 : 8;
+    uint8_t mask   = (0xff << top) & (0xff >> (8 - bottom));
+    uint8_t *px    = &device->pixels[p][x];
+    mark_dirty(device, p, x, x1);
+
+    switch(op) {
+      case RECT_SET:
+        if(mask == 0xff)
+          memset(px, 0xff, cols);
+        else
+          for(int i = 0; i < cols; ++i)
+            px[i] |= mask;
+        break;
+
+      case RECT_CLEAR:
+        if(mask == 0xff)
+          memset(px, 0, cols);
+        else
+          for(int i = 0; i < cols; ++i)
+            px[i] &= ~mask;
+        break;
+
+      case RECT_INVERT:
+        for(int i = 0; i < cols; ++i)
+          px[i] ^= mask;
+        break;
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Fill a rectangle with ink
+//------------------------------------------------------------------------------
+int32_t PCD8544_fill_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  return rect_op(device, x, y, width, height, RECT_SET);
+}
+
+//------------------------------------------------------------------------------
+// Clear a rectangle
+//------------------------------------------------------------------------------
+int32_t PCD8544_clear_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  return rect_op(device, x, y, width, height, RECT_CLEAR);
+}
+
+//------------------------------------------------------------------------------
+// Invert a rectangle
+//------------------------------------------------------------------------------
+int32_t PCD8544_invert_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  return rect_op(device, x, y, width, height, RECT_INVERT);
+}
+
+//------------------------------------------------------------------------------
+// Draw a horizontal line
+//------------------------------------------------------------------------------
+int32_t PCD8544_hline(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t length)
+{
+  return rect_op(device, x, y, length, 1, RECT_SET);
+}
+
+//------------------------------------------------------------------------------
+// Draw a vertical line
+//------------------------------------------------------------------------------
+int32_t PCD8544_vline(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t length)
+{
+  return rect_op(device, x, y, 1, length, RECT_SET);
+}
+
+//------------------------------------------------------------------------------
+// Get all the 48 pixels of a column
+//------------------------------------------------------------------------------
+static uint64_t get_column(pcd8544 *device, uint16_t x)
+{
+  uint64_t column = 0;
+  for(int p = 5; p >= 0; --p)
+    column = (column << 8) | device->pixels[p][x];
+  return column;
+}
+
+//------------------------------------------------------------------------------
+// Set all the 48 pixels of a column
+//------------------------------------------------------------------------------
+static void put_column(pcd8544 *device, uint16_t x, uint64_t column)
+{
+  for(int p = 0; p < 6; ++p, column >>= 8)
+    device->pixels[p][x] = column;
+}
+
+//------------------------------------------------------------------------------
+// Copy a rectangle
+//------------------------------------------------------------------------------
+int32_t PCD8544_copy_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, uint16_t to_x, uint16_t to_y)
+{
+  if(x > 83 || y > 47 || to_x > 83 || to_y > 47)
+    return -IO_EINVAL;
+
+  if(x + width > 84)     width  = 84 - x;
+  if(to_x + width > 84)  width  = 84 - to_x;
+  if(y + height > 48)    height = 48 - y;
+  if(to_y + height > 48) height = 48 - to_y;
+  if(!width || !height)
+    return 0;
+
+  //----------------------------------------------------------------------------
+  // A whole column fits in a double word, so the vertical move is a shift;
+  // walk the columns away from the direction of the move to handle overlaps
+  //----------------------------------------------------------------------------
+  uint64_t mask = (1ULL << height) - 1;
+  int step  = to_x > x ? -1 : 1;
+  int i     = to_x > x ? width - 1 : 0;
+  int end   = to_x > x ? -1 : width;
+  for(; i != end; i += step) {
+    uint64_t src = (get_column(device, x+i) >> y) & mask;
+    uint64_t dst = get_column(device, to_x+i);
+    dst = (dst & ~(mask << to_y)) | (src << to_y);
+    put_column(device, to_x+i, dst);
+  }
+
+  for(int p = to_y/8; p <= (to_y+height-1)/8; ++p)
+    mark_dirty(device, p, to_x, to_x+width);
   return 0;
 }
 
@@ -136,12 +428,44 @@ int32_t PCD8544_put_pixel(pcd8544 *device, uint16_t x, uint16_t y,
 //------------------------------------------------------------------------------
 int32_t PCD8544_sync(pcd8544 *device)
 {
-  IO_set(&device->dc, 0);
-  IO_write(&device->ssi, cursor_rst_seq, sizeof(cursor_rst_seq));
-  IO_sync(&device->ssi);
-  IO_set(&device->dc, 1);
-  for(int i = 0; i < 6; ++i)
-    IO_write(&device->ssi, device->pixels[i], 84);
+  //----------------------------------------------------------------------------
+  // Send only the modified span of every page. The controller advances the
+  // cursor by itself and wraps to the next page at the end of a row, so we
+  // only need to move it when the spans are not contiguous. The contiguous
+  // spans are gathered and go out in one vectored write.
+  //----------------------------------------------------------------------------
+  IO_iovec iov[6];
+  uint32_t num = 0;
+  int page = -1;
+  int col  = -1;
+  for(int i = 0; i < 6; ++i) {
+    uint8_t first = device->dirty[i][0];
+    uint8_t last  = device->dirty[i][1];
+    if(first >= last)
+      continue;
+
+    if(page != i || col != first) {
+      if(num)
+        IO_writev(&device->ssi, iov, num);
+      num = 0;
+      uint8_t cursor_seq[] = {0x20, 0x40 | i, 0x80 | first};
+      IO_sync(&device->ssi);
+      IO_set(&device->dc, 0);
+      IO_write(&device->ssi, cursor_seq, sizeof(cursor_seq));
+      IO_sync(&device->ssi);
+      IO_set(&device->dc, 1);
+    }
+    iov[num].base   = &device->pixels[i][first];
+    iov[num].length = last-first;
+    ++num;
+
+    page = last == 84 ? i + 1 : i;
+    col  = last == 84 ? 0 : last;
+    device->dirty[i][0] = 84;
+    device->dirty[i][1] = 0;
+  }
+  if(num)
+    IO_writev(&device->ssi, iov, num);
   IO_sync(&device->ssi);
   IO_set(&device->dc, 0);
   return 0;
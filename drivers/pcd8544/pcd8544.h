@@ -31,6 +31,7 @@ struct pcd8544 {
   IO_io dc;               //!< Data/~Command GPIO
   IO_io ssi;              //!< Communication interface
   uint8_t pixels[6][84];  //!< Pixel matrix
+  uint8_t dirty[6][2];    //!< Modified columns [first, last) of every page
 };
 
 typedef struct pcd8544 pcd8544;
@@ -58,6 +59,77 @@ int32_t PCD8544_put_pixel(pcd8544 *device, uint16_t x, uint16_t y,
   uint32_t argb);
 
 //------------------------------------------------------------------------------
-//! Write the picel matrix to the device
+//! Blit a box of packed columns
+//!
+//! Each column is stored as (height+7)/8 bytes with the top row in the least
+//! significant bit of the first byte; set bits are black. The whole box is
+//! overwritten and whatever falls outside of the screen is clipped.
+//------------------------------------------------------------------------------
+int32_t PCD8544_blit(pcd8544 *device, uint16_t x, uint16_t y, uint16_t width,
+  uint16_t height, const uint8_t *data);
+
+//------------------------------------------------------------------------------
+//! Blit a bitmap through a mask; only the pixels set in the mask are
+//! overwritten, if the mask is null, the whole box is
+//------------------------------------------------------------------------------
+int32_t PCD8544_blit_masked(pcd8544 *device, uint16_t x, uint16_t y,
+  const IO_bitmap *bitmap, const IO_bitmap *mask);
+
+//------------------------------------------------------------------------------
+//! Get the color of a pixel
+//------------------------------------------------------------------------------
+int32_t PCD8544_get_pixel(pcd8544 *device, uint16_t x, uint16_t y,
+  uint32_t *argb);
+
+//------------------------------------------------------------------------------
+//! Describe the pixel matrix as a framebuffer
+//------------------------------------------------------------------------------
+int32_t PCD8544_get_framebuffer(pcd8544 *device, IO_framebuffer *fb);
+
+//------------------------------------------------------------------------------
+//! Mark a rectangle modified behind the driver's back for the next sync
+//------------------------------------------------------------------------------
+int32_t PCD8544_mark_dirty(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Fill a rectangle with ink
+//------------------------------------------------------------------------------
+int32_t PCD8544_fill_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Clear a rectangle
+//------------------------------------------------------------------------------
+int32_t PCD8544_clear_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Invert a rectangle
+//------------------------------------------------------------------------------
+int32_t PCD8544_invert_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Draw a horizontal line
+//------------------------------------------------------------------------------
+int32_t PCD8544_hline(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t length);
+
+//------------------------------------------------------------------------------
+//! Draw a vertical line
+//------------------------------------------------------------------------------
+int32_t PCD8544_vline(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t length);
+
+//------------------------------------------------------------------------------
+//! Copy a rectangle; the source and the destination may overlap
+//------------------------------------------------------------------------------
+int32_t PCD8544_copy_rect(pcd8544 *device, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, uint16_t to_x, uint16_t to_y);
+
+//------------------------------------------------------------------------------
+//! Write the parts of the pixel matrix modified since the last sync to the
+//! device
 //------------------------------------------------------------------------------
 int32_t PCD8544_sync(pcd8544 *device);
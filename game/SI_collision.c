@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "SI_collision.h"
+
+//------------------------------------------------------------------------------
+// Objects of the scene sorted along the x axis. The order is kept between
+// frames, so the insertion sort has next to nothing to do when the objects
+// move just a bit.
+//------------------------------------------------------------------------------
+static uint8_t   order[255];
+static SI_scene *order_scene;
+static uint8_t   order_size;
+
+//------------------------------------------------------------------------------
+// Sort the objects by their left edge
+//------------------------------------------------------------------------------
+static void sort_objects(SI_scene *scene)
+{
+  SI_object **objects = scene->objects;
+  uint8_t     num     = scene->num_objects;
+
+  if(order_scene != scene || order_size != num) {
+    for(int i = 0; i < num; ++i)
+      order[i] = i;
+    order_scene = scene;
+    order_size  = num;
+  }
+
+  for(int i = 1; i < num; ++i) {
+    uint8_t  index = order[i];
+    uint16_t x     = objects[index]->x;
+    int j = i - 1;
+    for(; j >= 0 && objects[order[j]]->x > x; --j)
+      order[j+1] = order[j];
+    order[j+1] = index;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get 32 rows of a column of the shape of an object, starting at the given
+// row, in the least significant bit; the rows past the bottom are clear
+//------------------------------------------------------------------------------
+static uint32_t get_column(const SI_object *obj, uint16_t col, uint16_t row)
+{
+  const IO_bitmap *bmp    = obj->shape;
+  uint16_t         height = bmp ? bmp->height : obj->height;
+  if(row >= height)
+    return 0;
+
+  uint16_t left = height - row;
+  uint32_t mask = left >= 32 ? 0xffffffff : (1UL << left) - 1;
+  if(!bmp)
+    return mask;
+
+  //----------------------------------------------------------------------------
+  // The row does not need to be page-aligned, so we take five pages to have
+  // 32 rows after the shift
+  //----------------------------------------------------------------------------
+  uint8_t        pages = (bmp->height + 7) / 8;
+  uint8_t        page  = row / 8;
+  const uint8_t *data  = bmp->data;
+  uint64_t       bits  = 0;
+
+  data += col * pages;
+  for(int p = 0; p < 5 && page + p < pages; ++p)
+    bits |= (uint64_t)data[page + p] << (8*p);
+  return (uint32_t)(bits >> (row % 8)) & mask;
+}
+
+//------------------------------------------------------------------------------
+// Check whether the shapes of two objects overlap
+//------------------------------------------------------------------------------
+int SI_collision_pixel(const SI_object *obj1, const SI_object *obj2,
+  uint16_t *x, uint16_t *y)
+{
+  uint16_t left   = obj1->x > obj2->x ? obj1->x : obj2->x;
+  uint16_t top    = obj1->y > obj2->y ? obj1->y : obj2->y;
+  uint16_t right  = obj1->x + obj1->width;
+  uint16_t bottom = obj1->y + obj1->height;
+  if(obj2->x + obj2->width < right)
+    right = obj2->x + obj2->width;
+  if(obj2->y + obj2->height < bottom)
+    bottom = obj2->y + obj2->height;
+
+  if(left >= right || top >= bottom)
+    return 0;
+
+  //----------------------------------------------------------------------------
+  // Walk the overlap column by column, in bands of 32 rows, so that the
+  // contact point is the top-most pixel of the left-most column
+  //----------------------------------------------------------------------------
+  for(uint16_t col = left; col < right; ++col) {
+    for(uint16_t band = top; band < bottom; band += 32) {
+      uint16_t rows = bottom - band;
+      uint32_t mask = rows >= 32 ? 0xffffffff : (1UL << rows) - 1;
+      uint32_t col1 = get_column(obj1, col - obj1->x, band - obj1->y);
+      uint32_t col2 = get_column(obj2, col - obj2->x, band - obj2->y);
+      uint32_t hit  = col1 & col2 & mask;
+      if(hit) {
+        *x = col;
+        *y = band + __builtin_ctz(hit);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Detect collisions
+//------------------------------------------------------------------------------
+void SI_collision_detect(SI_scene *scene)
+{
+  if(!scene->collision)
+    return;
+
+  sort_objects(scene);
+
+  //----------------------------------------------------------------------------
+  // Sweep from left to right; an object can only overlap with the ones that
+  // start before its right edge
+  //----------------------------------------------------------------------------
+  SI_object **objects = scene->objects;
+  uint8_t     num     = scene->num_objects;
+  for(int i = 0; i < num; ++i) {
+    uint8_t    index1 = order[i];
+    SI_object *obj1   = objects[index1];
+    if(!(obj1->flags & SI_OBJECT_VISIBLE) || !(obj1->layer | obj1->mask))
+      continue;
+
+    uint16_t right = obj1->x + obj1->width;
+    for(int j = i + 1; j < num; ++j) {
+      uint8_t    index2 = order[j];
+      SI_object *obj2   = objects[index2];
+      if(obj2->x >= right)
+        break;
+
+      //------------------------------------------------------------------------
+      // The callback may have hidden any of the two
+      //------------------------------------------------------------------------
+      if(!(obj1->flags & SI_OBJECT_VISIBLE))
+        break;
+      if(!(obj2->flags & SI_OBJECT_VISIBLE))
+        continue;
+
+      uint8_t hit12 = obj1->mask & obj2->layer;
+      uint8_t hit21 = obj2->mask & obj1->layer;
+      if(!hit12 && !hit21)
+        continue;
+
+      if(obj1->y >= obj2->y + obj2->height || obj2->y >= obj1->y + obj1->height)
+        continue;
+
+      uint16_t x, y;
+      if(!SI_collision_pixel(obj1, obj2, &x, &y))
+        continue;
+
+      if(hit12 && (!hit21 || index1 < index2))
+        scene->collision(obj1, obj2, x, y);
+      else
+        scene->collision(obj2, obj1, x, y);
+    }
+  }
+}
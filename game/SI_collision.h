@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SI_scene.h"
+
+//------------------------------------------------------------------------------
+//! Detect collisions between the visible objects of the scene
+//!
+//! Two objects are tested against each other only if the mask of one of them
+//! has a common bit with the layer of the other one. Every overlapping pair is
+//! reported once through the collision callback of the scene, together with
+//! the first contact point, with the object whose mask matched as the first
+//! argument. If both masks match, the object
+//! that comes first in the scene goes first.
+//!
+//! The bounding boxes are tested first, and only the pairs that overlap are
+//! checked pixel by pixel with SI_collision_pixel.
+//------------------------------------------------------------------------------
+void SI_collision_detect(SI_scene *scene);
+
+//------------------------------------------------------------------------------
+//! Check whether the shapes of two objects overlap
+//!
+//! Shapes are packed bitmaps of any height; objects without a shape are solid
+//! boxes. Each column of the overlapping area is compared in bands of 32
+//! rows.
+//!
+//! @param obj1 the first object
+//! @param obj2 the second object
+//! @param x    output for the x coordinate of the first contact point
+//! @param y    output for the y coordinate of the first contact point
+//! @return     1 if the shapes overlap, 0 otherwise
+//------------------------------------------------------------------------------
+int SI_collision_pixel(const SI_object *obj1, const SI_object *obj2,
+  uint16_t *x, uint16_t *y);
@@ -30,46 +30,110 @@
 IO_io display;
 IO_io scene_timer;
 IO_io slider;
-IO_io slider_timer;
 IO_io button[2];
 IO_io sound;
 IO_sound_player sound_player;
 IO_io led;
+IO_io console;
 
 //------------------------------------------------------------------------------
 // Hardware variables
 //------------------------------------------------------------------------------
 uint64_t         slider_value = 0;
-uint64_t         button_value = 0;
 IO_display_attrs display_attrs;
 uint8_t          rng_initialized;
 
 //------------------------------------------------------------------------------
-// Slider timer event
+// Input queue; the buttons and the slider report from interrupt handlers of
+// the same priority, so they never preempt each other and the queue has a
+// single producer and a single consumer - the game thread. The producer only
+// moves the head and the consumer only moves the tail.
 //------------------------------------------------------------------------------
-void slider_timer_event(IO_io *io, uint16_t event)
+#define SI_INPUT_QUEUE     16 // needs to be a power of two
+#define SI_SLIDER_HYSTERESIS 8
+
+static SI_input_event    input_queue[SI_INPUT_QUEUE];
+static volatile uint16_t input_head;
+static volatile uint16_t input_tail;
+static uint16_t          input_end;    // snapshot of the head
+static uint64_t          input_slider; // last reported slider position
+static SI_input_stats    input_stats;
+
+//------------------------------------------------------------------------------
+// Record an input event
+//------------------------------------------------------------------------------
+static void input_push(uint8_t source, uint8_t id, uint16_t value,
+  uint64_t time)
 {
-  IO_set(&slider, 0); // request a sample
+  uint16_t head = input_head;
+  if((uint16_t)(head - input_tail) == SI_INPUT_QUEUE) {
+    ++input_stats.dropped;
+    return;
+  }
+
+  SI_input_event *ev = &input_queue[head & (SI_INPUT_QUEUE-1)];
+  ev->time   = time;
+  ev->value  = value;
+  ev->source = source;
+  ev->id     = id;
+  input_head = head + 1; // publish the event
 }
 
 //------------------------------------------------------------------------------
-// Slider event
+// Start consuming the input of an update tick
 //------------------------------------------------------------------------------
-void slider_event(IO_io *io, uint16_t event)
+void SI_input_begin()
 {
-  IO_get(&slider, &slider_value);
-  IO_set(&slider_timer, 20000000); // fire in 0.04 sec
+  input_end = input_head;
+}
+
+//------------------------------------------------------------------------------
+// Get the next input event of the tick
+//------------------------------------------------------------------------------
+int SI_input_next(SI_input_event *event)
+{
+  uint16_t tail = input_tail;
+  if(tail == input_end)
+    return 0;
+
+  *event = input_queue[tail & (SI_INPUT_QUEUE-1)];
+  input_tail = tail + 1;
+
+  ++input_stats.events;
+  if(event->source == SI_INPUT_BUTTON && event->value) {
+    input_stats.latency_last = IO_time() - event->time;
+    if(input_stats.latency_last > input_stats.latency_max)
+      input_stats.latency_max = input_stats.latency_last;
+  }
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// Drop all the pending input
+//------------------------------------------------------------------------------
+void SI_input_flush()
+{
+  input_end  = input_head;
+  input_tail = input_end;
+}
+
+//------------------------------------------------------------------------------
+// Get the input statistics
+//------------------------------------------------------------------------------
+void SI_input_get_stats(SI_input_stats *stats)
+{
+  *stats = input_stats;
 }
 
 //------------------------------------------------------------------------------
-// An button event
+// A button event; the buttons are debounced, so every change is a clean
+// press or release stamped with the time of its first edge
 //------------------------------------------------------------------------------
 void button_event(IO_io *io, uint16_t event)
 {
   uint64_t btn;
   IO_get(io, &btn);
-  if(btn)
-    button_value = 1;
+  input_push(SI_INPUT_BUTTON, io == &button[1], btn, IO_gpio_timestamp(io));
 
   if(!rng_initialized) {
     rng_initialized = 1;
@@ -77,6 +141,21 @@ void button_event(IO_io *io, uint16_t event)
   }
 }
 
+//------------------------------------------------------------------------------
+// Half of the slider ring has been filled; report the position if it has
+// moved far enough to not be noise
+//------------------------------------------------------------------------------
+void slider_event(IO_io *io, uint16_t event)
+{
+  uint64_t pos;
+  IO_get(io, &pos);
+  if(pos + SI_SLIDER_HYSTERESIS > input_slider &&
+     pos < input_slider + SI_SLIDER_HYSTERESIS)
+    return;
+  input_slider = pos;
+  input_push(SI_INPUT_SLIDER, 0, pos, IO_time());
+}
+
 //------------------------------------------------------------------------------
 //! Initialize the hardware
 //------------------------------------------------------------------------------
@@ -87,15 +166,16 @@ void SI_hardware_init()
   IO_display_init(&display, 0);
   IO_display_get_attrs(&display, &display_attrs);
 
-  IO_timer_init(&slider_timer, 1);
-  IO_slider_init(&slider, 0, IO_ASYNC);
-  slider_timer.event = slider_timer_event;
-  slider.event       = slider_event;
-  IO_event_enable(&slider, IO_EVENT_DONE);
-  IO_set(&slider, 0); // request a sample
+  // sampled in the background, the game reads the latest value every tick
+  IO_slider_init(&slider, 0, IO_BUFFERED);
+  IO_get(&slider, &slider_value);
+  input_slider = slider_value;
+  slider.event = slider_event;
 
   IO_button_init(&button[0], 0, IO_ASYNC);
   IO_button_init(&button[1], 1, IO_ASYNC);
+  IO_gpio_debounce(&button[0], 10);
+  IO_gpio_debounce(&button[1], 10);
   button[0].event = button_event;
   button[1].event = button_event;
   IO_event_enable(&button[0], IO_EVENT_CHANGE);
@@ -105,4 +185,6 @@ void SI_hardware_init()
   IO_sound_player_init(&sound_player, &sound);
 
   IO_led_init(&led, 0);
+
+  IO_uart_init(&console, 0, IO_BUFFERED, 115200);
 }
@@ -26,17 +26,75 @@
 // Devices
 //------------------------------------------------------------------------------
 extern IO_io display;
+extern IO_io slider;
 extern IO_io sound;
 extern IO_sound_player sound_player;
 extern IO_io led;
+extern IO_io console;
 
 //------------------------------------------------------------------------------
 // Hardware values
 //------------------------------------------------------------------------------
 extern uint64_t         slider_value;
-extern uint64_t         button_value;
 extern IO_display_attrs display_attrs;
 
+//------------------------------------------------------------------------------
+// Input event sources
+//------------------------------------------------------------------------------
+#define SI_INPUT_BUTTON 0
+#define SI_INPUT_SLIDER 1
+
+//------------------------------------------------------------------------------
+//! Input event
+//------------------------------------------------------------------------------
+struct SI_input_event {
+  uint64_t time;    //!< when the change happened, in miliseconds
+  uint16_t value;   //!< state of the button or position of the slider
+  uint8_t  source;  //!< SI_INPUT_BUTTON or SI_INPUT_SLIDER
+  uint8_t  id;      //!< number of the button
+};
+
+typedef struct SI_input_event SI_input_event;
+
+//------------------------------------------------------------------------------
+//! Start consuming the input of an update tick
+//!
+//! Takes a snapshot of the queue; SI_input_next returns only the events
+//! recorded before the snapshot, so what an update sees does not depend on
+//! the interrupts that fire while it runs.
+//------------------------------------------------------------------------------
+void SI_input_begin();
+
+//------------------------------------------------------------------------------
+//! Get the next input event of the tick
+//!
+//! @return 1 if there was an event, 0 otherwise
+//------------------------------------------------------------------------------
+int SI_input_next(SI_input_event *event);
+
+//------------------------------------------------------------------------------
+//! Drop all the pending input
+//------------------------------------------------------------------------------
+void SI_input_flush();
+
+//------------------------------------------------------------------------------
+//! Input statistics
+//------------------------------------------------------------------------------
+struct SI_input_stats {
+  uint32_t events;       //!< events consumed
+  uint32_t dropped;      //!< events lost because the queue was full
+  uint32_t latency_last; //!< latency of the last button press in ms
+  uint32_t latency_max;  //!< maximum latency of a button press in ms
+};
+
+typedef struct SI_input_stats SI_input_stats;
+
+//------------------------------------------------------------------------------
+//! Get the input statistics; the latency is the time between the first edge
+//! of a button press and the update consuming it
+//------------------------------------------------------------------------------
+void SI_input_get_stats(SI_input_stats *stats);
+
 //------------------------------------------------------------------------------
 //! Initialize the hardware
 //------------------------------------------------------------------------------
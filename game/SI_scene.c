@@ -22,6 +22,7 @@
 #include <io/IO_utils.h>
 
 #include "SI_scene.h"
+#include "SI_collision.h"
 
 //------------------------------------------------------------------------------
 // Bitmap
@@ -29,7 +30,22 @@
 void SI_object_bitmap_draw(SI_object *obj, IO_io *display)
 {
   SI_object_bitmap *this = CONTAINER_OF(SI_object_bitmap, obj, obj);
-  IO_display_print_bitmap(display, obj->x, obj->y, this->bmp);
+  const IO_bitmap *bmp = this->bmp;
+
+  //----------------------------------------------------------------------------
+  // Run the compiled routine if the sprite has one and fits on the screen
+  // entirely; they do not clip
+  //----------------------------------------------------------------------------
+  IO_framebuffer fb;
+  if(bmp->draw && !IO_display_get_framebuffer(display, &fb) &&
+     obj->x + bmp->width <= fb.width && obj->y + bmp->height <= fb.height) {
+    bmp->draw[obj->y % 8](fb.pixels + (obj->y / 8) * fb.stride + obj->x,
+                          fb.stride);
+    IO_display_mark_dirty(display, obj->x, obj->y, bmp->width, bmp->height);
+    return;
+  }
+
+  IO_display_print_bitmap(display, obj->x, obj->y, bmp);
 }
 
 void SI_object_bitmap_cons(SI_object_bitmap *obj, const IO_bitmap *bmp)
@@ -37,7 +53,9 @@ void SI_object_bitmap_cons(SI_object_bitmap *obj, const IO_bitmap *bmp)
   obj->bmp        = bmp;
   obj->obj.width  = bmp->width;
   obj->obj.height = bmp->height;
+  obj->obj.shape  = bmp;
   obj->obj.draw   = SI_object_bitmap_draw;
+  obj->obj.flags |= SI_OBJECT_DIRTY;
 }
 
 //------------------------------------------------------------------------------
@@ -46,60 +64,375 @@ void SI_object_bitmap_cons(SI_object_bitmap *obj, const IO_bitmap *bmp)
 void SI_object_text_draw(SI_object *obj, IO_io *display)
 {
   SI_object_text *this = CONTAINER_OF(SI_object_text, obj, obj);
-  IO_display_set_font(display, this->font);
-  IO_display_cursor_goto(display, obj->x, obj->y);
-  IO_print(display, "%s", this->text);
+  IO_display_print_bitmap(display, obj->x, obj->y, &this->bmp);
+}
+
+void SI_object_text_set(SI_object_text *obj, const char *text)
+{
+  obj->text     = text;
+  obj->bmp.data = obj->pixels;
+  IO_font_render(obj->font, text, &obj->bmp, sizeof(obj->pixels));
+  obj->obj.width  = obj->bmp.width;
+  obj->obj.height = obj->bmp.height;
+  obj->obj.flags |= SI_OBJECT_DIRTY;
 }
 
 void SI_object_text_cons(SI_object_text *obj, const IO_font *font,
   const char *text)
 {
-  obj->text = text;
-  obj->font = font;
-  IO_font_get_box(font, text, &obj->obj.width, &obj->obj.height);
+  obj->font     = font;
   obj->obj.draw = SI_object_text_draw;
+  SI_object_text_set(obj, text);
 }
 
 //------------------------------------------------------------------------------
-// Rendere scene on the display
+// Profiling; every phase is measured from the end of the previous one
 //------------------------------------------------------------------------------
-void SI_scene_render(SI_scene *scene, IO_io *display)
+static uint32_t phase_stamp;
+
+static void phase_start()
 {
-  if(!scene || !display)
+  phase_stamp = IO_profiler_cycles();
+}
+
+static void phase_end(SI_scene *scene, uint8_t phase)
+{
+  uint32_t now = IO_profiler_cycles();
+  if(scene->profile)
+    IO_histogram_add(&scene->profile->phase[phase], now - phase_stamp);
+  phase_stamp = now;
+}
+
+//------------------------------------------------------------------------------
+// Initialize a profile
+//------------------------------------------------------------------------------
+void SI_profile_init(SI_profile *profile)
+{
+  for(int i = 0; i < SI_NUM_PHASES; ++i)
+    IO_histogram_init(&profile->phase[i], SI_PROFILE_WINDOW);
+  profile->frames   = 0;
+  profile->overruns = 0;
+}
+
+//------------------------------------------------------------------------------
+// Print the profile
+//------------------------------------------------------------------------------
+void SI_profile_print(SI_profile *profile, IO_io *io)
+{
+  static const char *names[] = {
+    "update", "collision", "clear", "draw", "sync", "frame"
+  };
+  IO_print(io, "%lu frames, %lu overruns, cycles min/avg/p99/max:\r\n",
+           profile->frames, profile->overruns);
+  for(int i = 0; i < SI_NUM_PHASES; ++i) {
+    IO_histogram_stats *st = &profile->phase[i].stats;
+    IO_print(io, "  %s: %lu/%lu/%lu/%lu\r\n", names[i], st->min, st->avg,
+             st->p99, st->max);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Damaged areas of the screen
+//------------------------------------------------------------------------------
+#define SI_MAX_DAMAGE 32
+
+struct SI_rect {
+  uint16_t x;
+  uint16_t y;
+  uint16_t width;
+  uint16_t height;
+};
+
+typedef struct SI_rect SI_rect;
+
+static SI_rect damage[SI_MAX_DAMAGE];
+static uint8_t num_damage;
+static uint8_t damage_overflow;
+
+static void add_damage(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+  if(num_damage == SI_MAX_DAMAGE) {
+    damage_overflow = 1;
     return;
+  }
+  damage[num_damage].x      = x;
+  damage[num_damage].y      = y;
+  damage[num_damage].width  = width;
+  damage[num_damage].height = height;
+  ++num_damage;
+}
 
-  if(scene->pre_render)
-    scene->pre_render(scene);
+static int is_damaged(SI_object *obj)
+{
+  for(int i = 0; i < num_damage; ++i)
+    if(obj->x < damage[i].x + damage[i].width &&
+       obj->x + obj->width > damage[i].x &&
+       obj->y < damage[i].y + damage[i].height &&
+       obj->y + obj->height > damage[i].y)
+      return 1;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Draw an object and remember where it has been drawn
+//------------------------------------------------------------------------------
+static void draw_object(SI_object *obj, IO_io *display)
+{
+  obj->draw(obj, display);
+  obj->prev_x      = obj->x;
+  obj->prev_y      = obj->y;
+  obj->prev_width  = obj->width;
+  obj->prev_height = obj->height;
+  obj->flags |= SI_OBJECT_DRAWN;
+  obj->flags &= ~SI_OBJECT_DIRTY;
+}
 
+//------------------------------------------------------------------------------
+// Draw everything from scratch
+//------------------------------------------------------------------------------
+static void draw_all(SI_scene *scene, IO_io *display)
+{
   IO_display_clear(display);
+  phase_end(scene, SI_PHASE_CLEAR);
+  for(int i = 0; i < scene->num_objects; ++i) {
+    SI_object *obj = scene->objects[i];
+    obj->flags &= ~SI_OBJECT_DRAWN;
+    if(obj->flags & SI_OBJECT_VISIBLE)
+      draw_object(obj, display);
+  }
+  scene->flags |= SI_SCENE_DRAWN;
+}
+
+//------------------------------------------------------------------------------
+// Draw only what has changed
+//------------------------------------------------------------------------------
+static void draw_changes(SI_scene *scene, IO_io *display)
+{
+  //----------------------------------------------------------------------------
+  // Erase the old boxes of everything that has changed and collect the areas
+  // that need to be redrawn
+  //----------------------------------------------------------------------------
+  num_damage      = 0;
+  damage_overflow = 0;
   for(int i = 0; i < scene->num_objects; ++i) {
     SI_object *obj = scene->objects[i];
-    if(!(obj->flags & SI_OBJECT_VISIBLE))
+    uint8_t visible = obj->flags & SI_OBJECT_VISIBLE;
+    uint8_t drawn   = obj->flags & SI_OBJECT_DRAWN;
+
+    if(!visible && !drawn)
+      continue;
+
+    if(visible && drawn && !(obj->flags & SI_OBJECT_DIRTY) &&
+       obj->x == obj->prev_x && obj->y == obj->prev_y &&
+       obj->width == obj->prev_width && obj->height == obj->prev_height)
       continue;
 
-    obj->draw(obj, display);
+    if(drawn) {
+      IO_display_clear_rect(display, obj->prev_x, obj->prev_y,
+                            obj->prev_width, obj->prev_height);
+      add_damage(obj->prev_x, obj->prev_y, obj->prev_width, obj->prev_height);
+      obj->flags &= ~SI_OBJECT_DRAWN;
+    }
+
+    if(visible)
+      add_damage(obj->x, obj->y, obj->width, obj->height);
   }
-  IO_sync(display);
 
-  if(scene->collision) {
+  //----------------------------------------------------------------------------
+  // Everything touching a damaged area needs to be redrawn, and redrawing it
+  // damages its own box, so grow the set until it stops changing
+  //----------------------------------------------------------------------------
+  int changed = 1;
+  while(changed && !damage_overflow) {
+    changed = 0;
     for(int i = 0; i < scene->num_objects; ++i) {
-      SI_object *obj1 = scene->objects[i];
-      if(!(obj1->flags & SI_OBJECT_VISIBLE) ||
-         !(obj1->flags & SI_OBJECT_TRACKABLE))
-        continue;
-
-      for(int j = 0; j < scene->num_objects; ++j) {
-        SI_object *obj2 = scene->objects[j];
-        if(obj1 == obj2 || !(obj2->flags & SI_OBJECT_VISIBLE))
-          continue;
-
-        if(obj1->x < obj2->x + obj2->width &&
-           obj1->x + obj1->width > obj2->x &&
-           obj1->y < obj2->y + obj2->height &&
-           obj1->height + obj1->y > obj2->y) {
-           scene->collision(obj1, obj2);
-        }
+      SI_object *obj = scene->objects[i];
+      if((obj->flags & SI_OBJECT_VISIBLE) && (obj->flags & SI_OBJECT_DRAWN) &&
+         is_damaged(obj)) {
+        obj->flags &= ~SI_OBJECT_DRAWN;
+        add_damage(obj->x, obj->y, obj->width, obj->height);
+        changed = 1;
       }
     }
   }
+
+  if(damage_overflow) {
+    draw_all(scene, display);
+    return;
+  }
+  phase_end(scene, SI_PHASE_CLEAR);
+
+  //----------------------------------------------------------------------------
+  // Redraw in the original order to keep the stacking
+  //----------------------------------------------------------------------------
+  for(int i = 0; i < scene->num_objects; ++i) {
+    SI_object *obj = scene->objects[i];
+    if((obj->flags & SI_OBJECT_VISIBLE) && !(obj->flags & SI_OBJECT_DRAWN))
+      draw_object(obj, display);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Rendere scene on the display
+//------------------------------------------------------------------------------
+void SI_scene_render(SI_scene *scene, IO_io *display)
+{
+  if(!scene || !display)
+    return;
+
+  phase_start();
+  if(scene->flags & SI_SCENE_DRAWN)
+    draw_changes(scene, display);
+  else
+    draw_all(scene, display);
+  phase_end(scene, SI_PHASE_DRAW);
+  IO_sync(display);
+  phase_end(scene, SI_PHASE_SYNC);
+}
+
+//------------------------------------------------------------------------------
+// Rate measurement
+//------------------------------------------------------------------------------
+static uint64_t rate_time;
+static uint16_t num_updates;
+static uint16_t num_renders;
+static uint16_t updates_per_sec;
+static uint16_t renders_per_sec;
+
+//------------------------------------------------------------------------------
+// Advance the simulation by one tick
+//------------------------------------------------------------------------------
+static void step(SI_scene *scene)
+{
+  for(int i = 0; i < scene->num_objects; ++i) {
+    SI_object *obj = scene->objects[i];
+    if(!(obj->flags & SI_OBJECT_INTERPOLATE))
+      continue;
+    if(obj->flags & SI_OBJECT_VISIBLE) {
+      obj->from_x = obj->x;
+      obj->from_y = obj->y;
+    }
+    else
+      obj->from_x = 0xffff; // just appeared, nothing to interpolate from
+  }
+
+  phase_start();
+  if(scene->update)
+    scene->update(scene, scene->tick);
+  phase_end(scene, SI_PHASE_UPDATE);
+  SI_collision_detect(scene);
+  phase_end(scene, SI_PHASE_COLLISION);
+  ++num_updates;
+}
+
+//------------------------------------------------------------------------------
+// Render the scene with the interpolated objects moved to where they would
+// be at this point of the current tick
+//------------------------------------------------------------------------------
+static uint8_t render(SI_scene *scene, IO_io *display)
+{
+  uint8_t moving = 0;
+  int32_t left   = scene->tick - scene->lag;
+  for(int i = 0; i < scene->num_objects; ++i) {
+    SI_object *obj = scene->objects[i];
+    obj->off_x = 0;
+    obj->off_y = 0;
+    if(!(obj->flags & SI_OBJECT_INTERPOLATE) ||
+       !(obj->flags & SI_OBJECT_VISIBLE) || obj->from_x == 0xffff)
+      continue;
+    if(obj->from_x != obj->x || obj->from_y != obj->y)
+      moving = 1;
+    obj->off_x = ((int32_t)obj->from_x - obj->x) * left / scene->tick;
+    obj->off_y = ((int32_t)obj->from_y - obj->y) * left / scene->tick;
+    obj->x += obj->off_x;
+    obj->y += obj->off_y;
+  }
+
+  SI_scene_render(scene, display);
+  ++num_renders;
+
+  for(int i = 0; i < scene->num_objects; ++i) {
+    SI_object *obj = scene->objects[i];
+    obj->x -= obj->off_x;
+    obj->y -= obj->off_y;
+  }
+  return moving;
+}
+
+//------------------------------------------------------------------------------
+// Run a frame of the scene
+//------------------------------------------------------------------------------
+#define SI_MAX_STEPS 5
+
+uint32_t SI_scene_frame(SI_scene *scene, IO_io *display)
+{
+  if(!scene || !display || !scene->tick)
+    return 0;
+
+  //----------------------------------------------------------------------------
+  // Accumulate the elapsed time; the first frame of a scene runs a step
+  // right away
+  //----------------------------------------------------------------------------
+  uint32_t frame_start = IO_profiler_cycles();
+  uint64_t now = IO_time();
+  if(!(scene->flags & SI_SCENE_STARTED)) {
+    scene->time   = now;
+    scene->lag    = scene->tick;
+    scene->flags |= SI_SCENE_STARTED;
+  }
+  scene->lag += now - scene->time;
+  scene->time = now;
+
+  //----------------------------------------------------------------------------
+  // Catch up with the clock, but drop the backlog if we are too far behind
+  // to ever catch up
+  //----------------------------------------------------------------------------
+  for(int steps = 0; scene->lag >= scene->tick; ++steps) {
+    if(steps == SI_MAX_STEPS) {
+      scene->lag %= scene->tick;
+      break;
+    }
+    step(scene);
+    scene->lag -= scene->tick;
+    if(scene->flags & SI_SCENE_STOPPED || !(scene->flags & SI_SCENE_STARTED))
+      return 0; // the scene has been switched or reconstructed
+  }
+
+  uint8_t moving = render(scene, display);
+
+  //----------------------------------------------------------------------------
+  // Account for the frame; it is over budget if it took longer than a tick
+  //----------------------------------------------------------------------------
+  if(scene->profile) {
+    SI_profile *profile = scene->profile;
+    uint32_t cycles = IO_profiler_cycles() - frame_start;
+    IO_histogram_add(&profile->phase[SI_PHASE_FRAME], cycles);
+    ++profile->frames;
+    if(cycles > IO_profiler_frequency() / 1000 * scene->tick)
+      ++profile->overruns;
+  }
+
+  //----------------------------------------------------------------------------
+  // Update the rates
+  //----------------------------------------------------------------------------
+  if(now - rate_time >= 1000) {
+    updates_per_sec = num_updates * 1000 / (now - rate_time);
+    renders_per_sec = num_renders * 1000 / (now - rate_time);
+    num_updates = 0;
+    num_renders = 0;
+    rate_time   = now;
+  }
+
+  if(moving)
+    return 1;
+  return scene->tick - scene->lag;
+}
+
+//------------------------------------------------------------------------------
+// Get the measured rates
+//------------------------------------------------------------------------------
+void SI_scene_get_rates(uint16_t *update_rate, uint16_t *render_rate)
+{
+  *update_rate = updates_per_sec;
+  *render_rate = renders_per_sec;
 }
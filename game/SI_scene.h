@@ -21,12 +21,24 @@
 
 #include <io/IO.h>
 #include <io/IO_font.h>
+#include <io/IO_profiler.h>
 
 //------------------------------------------------------------------------------
 // Object flags
 //------------------------------------------------------------------------------
 #define SI_OBJECT_VISIBLE   0x01
-#define SI_OBJECT_TRACKABLE 0x02
+#define SI_OBJECT_DIRTY     0x04  //!< the look changed, redraw on next frame
+#define SI_OBJECT_DRAWN     0x08  //!< on screen, maintained by the renderer
+#define SI_OBJECT_INTERPOLATE 0x10 //!< draw in between the simulation steps
+
+//------------------------------------------------------------------------------
+// Scene flags
+//------------------------------------------------------------------------------
+#define SI_SCENE_DRAWN      0x01  //!< rendered at least once, maintained by
+                                  //!< the renderer
+#define SI_SCENE_STARTED    0x02  //!< simulation clock running, maintained by
+                                  //!< the engine
+#define SI_SCENE_STOPPED    0x04  //!< another scene took over, do not step
 
 //------------------------------------------------------------------------------
 //! A scene object
@@ -36,8 +48,19 @@ struct SI_object {
   uint16_t y;
   uint16_t width;
   uint16_t height;
+  uint16_t prev_x;       //!< box that was drawn the last time
+  uint16_t prev_y;
+  uint16_t prev_width;
+  uint16_t prev_height;
   uint8_t  flags;
   uint8_t  user_flags;
+  uint8_t  layer;        //!< collision layers the object belongs to
+  uint8_t  mask;         //!< collision layers the object wants to hit
+  const IO_bitmap *shape; //!< pixels that can be hit, the whole box if null
+  uint16_t from_x;       //!< position before the last simulation step
+  uint16_t from_y;
+  int8_t   off_x;        //!< interpolation offset, maintained by the engine
+  int8_t   off_y;
   void (*draw)(struct SI_object *this, IO_io *display);
 };
 
@@ -57,11 +80,18 @@ void SI_object_bitmap_cons(SI_object_bitmap *obj, const IO_bitmap *bmp);
 
 //------------------------------------------------------------------------------
 //! A text object
+//!
+//! The text is rendered once into an off-screen bitmap and blitted from there;
+//! call SI_object_text_set whenever the string changes.
 //------------------------------------------------------------------------------
+#define SI_TEXT_BUFFER 168 //!< a full line of a two-page font
+
 struct SI_object_text {
   SI_object      obj;
   const char    *text;
   const IO_font *font;
+  IO_bitmap      bmp;                    //!< pre-rendered text
+  uint8_t        pixels[SI_TEXT_BUFFER]; //!< packed columns of the bitmap
 };
 
 typedef struct SI_object_text SI_object_text;
@@ -69,21 +99,86 @@ typedef struct SI_object_text SI_object_text;
 void SI_object_text_cons(SI_object_text *obj, const IO_font *font,
   const char *text);
 
+void SI_object_text_set(SI_object_text *obj, const char *text);
+
+//------------------------------------------------------------------------------
+//! Frame phases
+//------------------------------------------------------------------------------
+#define SI_PHASE_UPDATE     0  //!< the update callback
+#define SI_PHASE_COLLISION  1  //!< collision detection and callbacks
+#define SI_PHASE_CLEAR      2  //!< erasing the old boxes
+#define SI_PHASE_DRAW       3  //!< drawing the objects
+#define SI_PHASE_SYNC       4  //!< sending the pixels to the display
+#define SI_PHASE_FRAME      5  //!< the whole frame
+#define SI_NUM_PHASES       6
+
+#define SI_PROFILE_WINDOW   100 //!< number of samples per histogram window
+
+//------------------------------------------------------------------------------
+//! Cycle counts of the frame phases of a scene
+//------------------------------------------------------------------------------
+struct SI_profile {
+  IO_histogram phase[SI_NUM_PHASES];
+  uint32_t     frames;    //!< number of frames run
+  uint32_t     overruns;  //!< number of frames that took longer than a tick
+};
+
+typedef struct SI_profile SI_profile;
+
+//------------------------------------------------------------------------------
+//! Initialize a profile
+//------------------------------------------------------------------------------
+void SI_profile_init(SI_profile *profile);
+
+//------------------------------------------------------------------------------
+//! Print the statistics of the last complete windows
+//------------------------------------------------------------------------------
+void SI_profile_print(SI_profile *profile, IO_io *io);
+
 //------------------------------------------------------------------------------
 //! Scene descriptor
 //------------------------------------------------------------------------------
 struct SI_scene {
   SI_object **objects;                                       //!< list of object pointers
   void       *data;                                          //!< user data
-  void      (*pre_render)(struct SI_scene *);                //!< called before rendering
-  void      (*collision)(SI_object *obj1, SI_object *obj2);  //!< collision callback
-  uint8_t     fps;                                           //!< frames per second
+  SI_profile *profile;                                       //!< phase timings, may be null
+  void      (*update)(struct SI_scene *, uint32_t dt);       //!< advance by dt miliseconds
+  void      (*collision)(SI_object *obj1, SI_object *obj2,
+                         uint16_t x, uint16_t y);            //!< collision callback
+  uint64_t    time;                                          //!< time of the last frame
+  uint32_t    lag;                                           //!< time not simulated yet
+  uint16_t    tick;                                          //!< simulation step in miliseconds
   uint8_t     num_objects;                                   //!< number of objects
+  uint8_t     flags;                                         //!< scene flags
 };
 
 typedef struct SI_scene SI_scene;
 
 //------------------------------------------------------------------------------
 //! Rendere scene on the display
+//!
+//! The first frame of a scene is drawn from scratch. After that, only the
+//! objects that moved, changed visibility or have been marked as dirty are
+//! erased from their previous location, and only the objects overlapping the
+//! erased and the new locations are redrawn.
 //------------------------------------------------------------------------------
 void SI_scene_render(SI_scene *scene, IO_io *display);
+
+//------------------------------------------------------------------------------
+//! Run a frame of the scene
+//!
+//! The simulation is advanced in fixed steps of scene->tick miliseconds:
+//! the time elapsed since the previous frame is accumulated and the update
+//! and collision callbacks are run once for every full tick. Then the scene is
+//! rendered once; objects flagged with SI_OBJECT_INTERPOLATE are drawn in
+//! between their positions before and after the last step.
+//!
+//! @return number of miliseconds to wait before the next frame; short if
+//!         there is something to interpolate, until the next tick otherwise
+//------------------------------------------------------------------------------
+uint32_t SI_scene_frame(SI_scene *scene, IO_io *display);
+
+//------------------------------------------------------------------------------
+//! Get the update and render rates measured over the last second
+//------------------------------------------------------------------------------
+void SI_scene_get_rates(uint16_t *update_rate, uint16_t *render_rate);
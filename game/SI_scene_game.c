@@ -35,8 +35,8 @@ static uint32_t lives     = 3;
 static uint32_t score     = 0;
 static uint32_t level     = 1;
 static uint32_t invaders  = 5;
-static uint16_t x_pace    = 5;
-static uint16_t y_pace    = 100;
+static uint16_t x_pace    = 200;  // miliseconds per horizontal move
+static uint16_t y_pace    = 4000; // miliseconds per vertical move
 static uint16_t shot_prob = 100;
 static uint16_t hit_score = 25;
 
@@ -52,21 +52,16 @@ extern const IO_bitmap Invader2Img;
 extern const IO_bitmap Invader3Img;
 extern const IO_bitmap Invader4Img;
 
-const char MissleUpImgData[] = {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-const IO_bitmap MissleUpImg = {3, 6, 1, (void *)MissleUpImgData};
-
-const char MissleDownImgData[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1};
-const IO_bitmap MissleDownImg = {3, 6, 1, (void *)MissleDownImgData};
-
 //------------------------------------------------------------------------------
 // Game objects
 //------------------------------------------------------------------------------
 static SI_object_bitmap  defender_obj;
-static SI_object         score_obj;
+static SI_object_text    score_obj;
+static char              score_text[11];
 static SI_object_bitmap  life_obj[3];
 static SI_object_bitmap  invader_obj[5];
 static SI_object_bitmap  bunker_obj[3];
-static SI_object_bitmap  missle_obj[6];
+static SI_object         missle_obj[6];
 
 //------------------------------------------------------------------------------
 // Game object types
@@ -76,6 +71,15 @@ static SI_object_bitmap  missle_obj[6];
 #define SI_BUNKER    3
 #define SI_MISSLE    4
 
+//------------------------------------------------------------------------------
+// Collision layers
+//------------------------------------------------------------------------------
+#define SI_LAYER_DEFENDER         0x01
+#define SI_LAYER_INVADER          0x02
+#define SI_LAYER_BUNKER           0x04
+#define SI_LAYER_DEFENDER_MISSLE  0x08
+#define SI_LAYER_INVADER_MISSLE   0x10
+
 //------------------------------------------------------------------------------
 //! Set level for the game scene
 //------------------------------------------------------------------------------
@@ -88,37 +92,50 @@ void game_scene_set_level(uint8_t lvl)
     case 1:
       lives     = 3;
       score     = 0;
-      x_pace    = 4;
-      y_pace    = 80;
+      x_pace    = 160;
+      y_pace    = 3200;
       shot_prob = 80;
       break;
     case 2:
-      x_pace    = 3;
-      y_pace    = 60;
+      x_pace    = 120;
+      y_pace    = 2400;
       shot_prob = 60;
       break;
     case 3:
-      x_pace    = 2;
-      y_pace    = 40;
+      x_pace    = 80;
+      y_pace    = 1600;
       shot_prob = 40;
       break;
     case 4:
-      x_pace    = 1;
-      y_pace    = 20;
+      x_pace    = 40;
+      y_pace    = 800;
       shot_prob = 20;
       break;
   }
 }
 
 //------------------------------------------------------------------------------
-// Draw score
+// Draw missles; a 3x5 body with a one pixel tip in the direction of flight
 //------------------------------------------------------------------------------
-static void game_scene_draw_score(SI_object *obj, IO_io *display)
+static void game_scene_draw_missle_up(SI_object *obj, IO_io *display)
+{
+  IO_display_put_pixel(display, obj->x+1, obj->y, 0);
+  IO_display_fill_rect(display, obj->x, obj->y+1, 3, 5);
+}
+
+static void game_scene_draw_missle_down(SI_object *obj, IO_io *display)
 {
-  const IO_font *font = IO_font_get_by_name("SilkScreen8");
-  IO_display_set_font(display, font);
-  IO_display_cursor_goto(display, 0, 0);
-  IO_print(display, "%u", score);
+  IO_display_fill_rect(display, obj->x, obj->y, 3, 5);
+  IO_display_put_pixel(display, obj->x+1, obj->y+5, 0);
+}
+
+//------------------------------------------------------------------------------
+// Re-render the score, called only when it changes
+//------------------------------------------------------------------------------
+static void update_score()
+{
+  IO_snprintf(score_text, sizeof(score_text), "%lu", score);
+  SI_object_text_set(&score_obj, score_text);
 }
 
 //------------------------------------------------------------------------------
@@ -127,8 +144,24 @@ static void game_scene_draw_score(SI_object *obj, IO_io *display)
 static uint16_t invader_goal = 0;
 static uint16_t x_timer = 0;
 static uint16_t y_timer = 0;
-static void move_invaders(SI_object_bitmap *invaders)
+static void move_invaders(SI_object_bitmap *invaders, uint32_t dt)
 {
+  //----------------------------------------------------------------------------
+  // Check whether it's time to move
+  //----------------------------------------------------------------------------
+  uint8_t x_move = 0;
+  uint8_t y_move = 0;
+  x_timer += dt;
+  y_timer += dt;
+  if(x_timer >= x_pace) {
+    x_timer -= x_pace;
+    x_move   = 1;
+  }
+  if(y_timer >= y_pace) {
+    y_timer -= y_pace;
+    y_move   = 1;
+  }
+
   //----------------------------------------------------------------------------
   // Calculate the position of the left and right-most invaders
   //----------------------------------------------------------------------------
@@ -154,7 +187,7 @@ static void move_invaders(SI_object_bitmap *invaders)
   // Move the invaders towards the left goal
   //----------------------------------------------------------------------------
   else {
-    if(!x_timer) {
+    if(x_move) {
       int8_t step = 1;
       if(invader_goal < x_left)
         step = -1;
@@ -167,7 +200,7 @@ static void move_invaders(SI_object_bitmap *invaders)
 
     uint16_t height_limit = display_attrs.height - invaders[0].obj.height;
     height_limit -= bunker_obj[0].obj.y - 2;
-    if(!y_timer && invaders[0].obj.y > height_limit) {
+    if(y_move && invaders[0].obj.y > height_limit) {
       for(int i = 0; i < 5; ++i) {
         if(!(invaders[i].obj.flags & SI_OBJECT_VISIBLE))
           continue;
@@ -175,17 +208,26 @@ static void move_invaders(SI_object_bitmap *invaders)
       }
     }
   }
-  ++x_timer;
-  ++y_timer;
-  x_timer %= x_pace;
-  y_timer %= y_pace;
 }
 
 //------------------------------------------------------------------------------
-// Compute new positions of objects
+// Advance the game by one tick
 //------------------------------------------------------------------------------
-static void game_scene_pre_render(SI_scene *scene)
+static void game_scene_update(SI_scene *scene, uint32_t dt)
 {
+  //----------------------------------------------------------------------------
+  // Input of this tick
+  //----------------------------------------------------------------------------
+  SI_input_event ev;
+  uint8_t fire = 0;
+  SI_input_begin();
+  while(SI_input_next(&ev)) {
+    if(ev.source == SI_INPUT_SLIDER)
+      slider_value = ev.value;
+    else if(ev.value)
+      fire = 1;
+  }
+
   //----------------------------------------------------------------------------
   // Defender position
   //----------------------------------------------------------------------------
@@ -197,59 +239,58 @@ static void game_scene_pre_render(SI_scene *scene)
   //----------------------------------------------------------------------------
   // Defender missle
   //----------------------------------------------------------------------------
-  if(button_value && !(missle_obj[0].obj.flags & SI_OBJECT_VISIBLE)) {
-    missle_obj[0].obj.y = display_attrs.height - 10;
-    missle_obj[0].obj.x = defender_obj.obj.x + 4;
-    missle_obj[0].obj.flags |= SI_OBJECT_VISIBLE;
-    button_value = 0;
+  if(fire && !(missle_obj[0].flags & SI_OBJECT_VISIBLE)) {
+    missle_obj[0].y = display_attrs.height - 10;
+    missle_obj[0].x = defender_obj.obj.x + 4;
+    missle_obj[0].flags |= SI_OBJECT_VISIBLE;
     IO_sound_play(&sound_player, tune_shoot, 0);
   }
-  else if(missle_obj[0].obj.flags & SI_OBJECT_VISIBLE) {
-    if(missle_obj[0].obj.y <= 6)
-      missle_obj[0].obj.flags &= ~SI_OBJECT_VISIBLE;
+  else if(missle_obj[0].flags & SI_OBJECT_VISIBLE) {
+    if(missle_obj[0].y <= 6)
+      missle_obj[0].flags &= ~SI_OBJECT_VISIBLE;
     else
-      missle_obj[0].obj.y -= 2;
+      missle_obj[0].y -= 2;
   }
 
   //----------------------------------------------------------------------------
   // Invader position
   //----------------------------------------------------------------------------
-  move_invaders(invader_obj);
+  move_invaders(invader_obj, dt);
 
   //----------------------------------------------------------------------------
   // Invader missle
   //----------------------------------------------------------------------------
   for(int i = 0; i < 5; ++i) {
     uint8_t shoot = IO_random() % shot_prob;
-    if(shoot && !(missle_obj[i+1].obj.flags & SI_OBJECT_VISIBLE) &&
+    if(shoot && !(missle_obj[i+1].flags & SI_OBJECT_VISIBLE) &&
        (invader_obj[i].obj.flags & SI_OBJECT_VISIBLE)) {
-      missle_obj[i+1].obj.y  = invader_obj[i].obj.y + 1 + invader_obj[i].obj.height;
-      uint16_t x_off = invader_obj[i].obj.width - missle_obj[i+1].obj.width;
+      missle_obj[i+1].y  = invader_obj[i].obj.y + 1 + invader_obj[i].obj.height;
+      uint16_t x_off = invader_obj[i].obj.width - missle_obj[i+1].width;
       x_off /= 2;
-      missle_obj[i+1].obj.x = invader_obj[i].obj.x + x_off;
-      missle_obj[i+1].obj.flags |= SI_OBJECT_VISIBLE;
+      missle_obj[i+1].x = invader_obj[i].obj.x + x_off;
+      missle_obj[i+1].flags |= SI_OBJECT_VISIBLE;
     }
-    else if(missle_obj[i+1].obj.flags & SI_OBJECT_VISIBLE) {
-      if(missle_obj[i+1].obj.y >= display_attrs.height - 6)
-        missle_obj[i+1].obj.flags &= ~SI_OBJECT_VISIBLE;
+    else if(missle_obj[i+1].flags & SI_OBJECT_VISIBLE) {
+      if(missle_obj[i+1].y >= display_attrs.height - 6)
+        missle_obj[i+1].flags &= ~SI_OBJECT_VISIBLE;
       else
-        missle_obj[i+1].obj.y += 1;
+        missle_obj[i+1].y += 1;
     }
   }
-
-  button_value = 0;
 }
 
 //------------------------------------------------------------------------------
 // React to object collisions
 //------------------------------------------------------------------------------
-static void game_scene_collision(SI_object *obj1, SI_object *obj2)
+static void game_scene_collision(SI_object *obj1, SI_object *obj2, uint16_t x,
+  uint16_t y)
 {
   switch(obj2->user_flags) {
     case SI_INVADER:
       IO_sound_play(&sound_player, tune_hit, 0);
       --invaders;
       score += hit_score;
+      update_score();
       obj2->flags &= ~SI_OBJECT_VISIBLE;
       obj1->flags &= ~SI_OBJECT_VISIBLE;
       if(!invaders) {
@@ -283,6 +324,7 @@ static void game_scene_collision(SI_object *obj1, SI_object *obj2)
       obj2->flags &= ~SI_OBJECT_VISIBLE;
       obj1->flags &= ~SI_OBJECT_VISIBLE;
       ++score;
+      update_score();
       break;
 
     case SI_BUNKER:
@@ -314,12 +356,14 @@ void game_scene_setup(SI_scene *scene)
   defender_obj.obj.y = display_attrs.height - defender_obj.obj.height;
   defender_obj.obj.flags = SI_OBJECT_VISIBLE;
   defender_obj.obj.user_flags = SI_DEFENDER;
+  defender_obj.obj.layer = SI_LAYER_DEFENDER;
   scene->objects[0] = &defender_obj.obj;
 
   memset(&score_obj, 0, sizeof(score_obj));
-  score_obj.draw = game_scene_draw_score;
-  score_obj.flags = SI_OBJECT_VISIBLE;
-  scene->objects[1] = &score_obj;
+  SI_object_text_cons(&score_obj, IO_font_get_by_name("SilkScreen8"), "");
+  update_score();
+  score_obj.obj.flags |= SI_OBJECT_VISIBLE;
+  scene->objects[1] = &score_obj.obj;
 
   memset(life_obj, 0, sizeof(life_obj));
   for(int i = 0; i < 3; ++i) {
@@ -345,6 +389,7 @@ void game_scene_setup(SI_scene *scene)
     SI_object_bitmap_cons(&invader_obj[i], invader_img);
     invader_obj[i].obj.flags = SI_OBJECT_VISIBLE;
     invader_obj[i].obj.user_flags = SI_INVADER;
+    invader_obj[i].obj.layer = SI_LAYER_INVADER;
     invader_obj[i].obj.y = 8;
     invader_obj[i].obj.x = x_off + i*(invader_img->width+1);
     scene->objects[i+5] = &invader_obj[i].obj;
@@ -357,28 +402,38 @@ void game_scene_setup(SI_scene *scene)
     SI_object_bitmap_cons(&bunker_obj[i], &BunkerImg);
     bunker_obj[i].obj.flags = SI_OBJECT_VISIBLE;
     bunker_obj[i].obj.user_flags = SI_BUNKER;
+    bunker_obj[i].obj.layer = SI_LAYER_BUNKER;
     bunker_obj[i].obj.y = display_attrs.height - 8;
     bunker_obj[i].obj.x = i*bunker_area + bunker_offset;;
     scene->objects[i+10] = &bunker_obj[i].obj;
   }
 
   memset(missle_obj, 0, sizeof(missle_obj));
-  SI_object_bitmap_cons(&missle_obj[0], &MissleUpImg);
-  missle_obj[0].obj.flags = SI_OBJECT_TRACKABLE;
-  missle_obj[0].obj.user_flags = SI_MISSLE;
-  scene->objects[13] = &missle_obj[0].obj;
+  missle_obj[0].width  = 3;
+  missle_obj[0].height = 6;
+  missle_obj[0].draw   = game_scene_draw_missle_up;
+  missle_obj[0].flags = SI_OBJECT_INTERPOLATE;
+  missle_obj[0].user_flags = SI_MISSLE;
+  missle_obj[0].layer = SI_LAYER_DEFENDER_MISSLE;
+  missle_obj[0].mask  = SI_LAYER_INVADER | SI_LAYER_BUNKER |
+                        SI_LAYER_INVADER_MISSLE;
+  scene->objects[13] = &missle_obj[0];
 
   for(int i = 1; i < 6; ++i) {
-    SI_object_bitmap_cons(&missle_obj[i], &MissleDownImg);
-    missle_obj[i].obj.flags = SI_OBJECT_TRACKABLE;
-    missle_obj[i].obj.user_flags = SI_MISSLE;
-    scene->objects[13+i] = &missle_obj[i].obj;
+    missle_obj[i].width  = 3;
+    missle_obj[i].height = 6;
+    missle_obj[i].draw   = game_scene_draw_missle_down;
+    missle_obj[i].user_flags = SI_MISSLE;
+    missle_obj[i].layer = SI_LAYER_INVADER_MISSLE;
+    missle_obj[i].mask  = SI_LAYER_DEFENDER | SI_LAYER_BUNKER |
+                          SI_LAYER_DEFENDER_MISSLE;
+    scene->objects[13+i] = &missle_obj[i];
   }
 
-  scene->pre_render = game_scene_pre_render;
-  scene->collision  = game_scene_collision;
-  scene->fps   = 25;
-  button_value = 0;
+  scene->update    = game_scene_update;
+  scene->collision = game_scene_collision;
+  scene->tick      = 40;
+  SI_input_flush();
 
   IO_set(&led, 1);
 }
@@ -44,20 +44,24 @@ static SI_object_bitmap  invader_obj[4];
 static SI_object_text    press_obj;
 
 //------------------------------------------------------------------------------
-// Compute new positions of objects
+// Advance the scene
 //------------------------------------------------------------------------------
-static void intro_scene_pre_render(SI_scene *scene)
+static void intro_scene_update(SI_scene *scene, uint32_t dt)
 {
   if(press_obj.obj.flags & SI_OBJECT_VISIBLE)
     press_obj.obj.flags &= ~SI_OBJECT_VISIBLE;
   else
     press_obj.obj.flags |= SI_OBJECT_VISIBLE;
 
-  if(button_value) {
-    level_scene_set_level(1);
-    set_active_scene(SI_SCENE_LEVEL);
+  SI_input_event ev;
+  SI_input_begin();
+  while(SI_input_next(&ev)) {
+    if(ev.source == SI_INPUT_BUTTON && ev.value) {
+      level_scene_set_level(1);
+      set_active_scene(SI_SCENE_LEVEL);
+      break;
+    }
   }
-  button_value = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -127,6 +131,6 @@ void intro_scene_setup(SI_scene *scene)
   press_obj.obj.flags = SI_OBJECT_VISIBLE;
   scene->objects[6] = &press_obj.obj;
 
-  scene->pre_render = intro_scene_pre_render;
-  scene->fps   = 2;
+  scene->update = intro_scene_update;
+  scene->tick   = 500;
 }
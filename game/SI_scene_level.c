@@ -45,9 +45,9 @@ void level_scene_set_level(uint8_t lvl)
 }
 
 //------------------------------------------------------------------------------
-// Compute new positions of objects
+// Advance the scene
 //------------------------------------------------------------------------------
-static void level_scene_pre_render(SI_scene *scene)
+static void level_scene_update(SI_scene *scene, uint32_t dt)
 {
   if(!secs) {
     game_scene_set_level(level);
@@ -80,6 +80,6 @@ void level_scene_setup(SI_scene *scene)
   scene->objects[0] = &level_obj.obj;
 
   secs = 1;
-  scene->pre_render = level_scene_pre_render;
-  scene->fps   = 1;
+  scene->update = level_scene_update;
+  scene->tick   = 1000;
 }
@@ -34,22 +34,7 @@
 static SI_object_text score_obj[2];
 static uint32_t score = 0;
 static uint8_t secs  = 3;
-
-//------------------------------------------------------------------------------
-// Convert score
-//------------------------------------------------------------------------------
-static IO_io   sprintf_io;
-static char    score_str[32];
-static uint8_t score_size = 0;
-
-static int32_t sprintf_write(IO_io *io, const void *data, uint32_t length)
-{
-  const char *cdata = data;
-  for(int i = 0; i < length && score_size < 31; ++i, ++score_size)
-    score_str[score_size] = cdata[i];
-  score_str[score_size] = 0;
-  return length;
-}
+static char score_str[11];
 
 //------------------------------------------------------------------------------
 //! Set level for the game scene
@@ -60,9 +45,9 @@ void score_scene_set_score(uint32_t scor)
 }
 
 //------------------------------------------------------------------------------
-// Compute new positions of objects
+// Advance the scene
 //------------------------------------------------------------------------------
-static void score_scene_pre_render(SI_scene *scene)
+static void score_scene_update(SI_scene *scene, uint32_t dt)
 {
   if(!secs)
     set_active_scene(SI_SCENE_INTRO);
@@ -80,9 +65,7 @@ void score_scene_setup(SI_scene *scene)
     scene->num_objects = 2;
   }
 
-  score_size = 0;
-  sprintf_io.write = sprintf_write;
-  IO_print(&sprintf_io, "%lu", score);
+  IO_snprintf(score_str, sizeof(score_str), "%lu", score);
 
   const IO_font *font = IO_font_get_by_name("DejaVuSerif10");
   memset(&score_obj, 0, sizeof(score_obj));
@@ -103,6 +86,6 @@ void score_scene_setup(SI_scene *scene)
   }
 
   secs = 3;
-  scene->pre_render = score_scene_pre_render;
-  scene->fps   = 1;
+  scene->update = score_scene_update;
+  scene->tick   = 1000;
 }
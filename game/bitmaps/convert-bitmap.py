@@ -31,32 +31,73 @@ except ImportError, e:
     sys.exit(1)
 
 #-------------------------------------------------------------------------------
-# Get pixel data
+# Get pixel data packed in columns; every column is a sequence of bytes each
+# holding 8 rows with the top-most row in the least significant bit; a set bit
+# marks the ink (black)
 #-------------------------------------------------------------------------------
 def getPixelData(bmp):
   img = Image.open(bmp)
   px = img.load()
   width, height = img.size
-  pixels = []
-  for j in range(height):
+  pages = (height + 7) // 8
+  columns = []
+  for i in range(width):
+    for p in range(pages):
+      byte = 0
+      for b in range(8):
+        j = p * 8 + b
+        if j < height and px[i, j] == (0, 0, 0):
+          byte |= (1 << b)
+      columns.append(byte)
+  return (width, height, 1, columns)
+
+#-------------------------------------------------------------------------------
+# Write a straight-line routine drawing the bitmap shifted down by shift rows
+# within a framebuffer page; every column of every page it touches is written
+# once, under a mask unless the whole byte is covered
+#-------------------------------------------------------------------------------
+def writeDrawRoutine(f, name, bitmap, shift):
+  width, height, bpp, data = bitmap
+  pages = (height + 7) // 8
+  f.write("static void " + name + "_draw" + str(shift))
+  f.write("(uint8_t *pixels, uint16_t stride)\n{\n")
+  box = ((1 << height) - 1) << shift
+  for p in range((height + shift + 7) // 8):
+    if p:
+      f.write("  pixels += stride;\n")
+    mask = (box >> (8 * p)) & 0xff
     for i in range(width):
-      if px[i, j] == (0, 0, 0):
-        pixels.append(0)
+      column = 0
+      for b in range(pages):
+        column |= data[i * pages + b] << (8 * b)
+      value = ((column << shift) >> (8 * p)) & mask
+      if mask == 0xff:
+        f.write("  pixels[%d] = 0x%02x;\n" % (i, value))
+      elif not value:
+        f.write("  pixels[%d] &= 0x%02x;\n" % (i, ~mask & 0xff))
       else:
-        pixels.append(1)
-  return (width, height, 1, pixels)
+        f.write("  pixels[%d] = (pixels[%d] & 0x%02x) | 0x%02x;\n" %
+                (i, i, ~mask & 0xff, value))
+  f.write("}\n\n")
 
 #-------------------------------------------------------------------------------
 # Write bitmap
 #-------------------------------------------------------------------------------
-def writeBitmap(f, name, bitmap):
+def writeBitmap(f, name, bitmap, compiled):
   f.write("// This file has been generated autmatically, do not edit!\n\n")
   f.write("#include <io/IO.h>\n\n")
-  f.write("static const char " + name + "_data[] = ");
-  f.write("{" + str(bitmap[3])[1:-1] + "};\n");
+  f.write("static const uint8_t " + name + "_data[] = {\n  ");
+  f.write(", ".join(["0x%02x" % b for b in bitmap[3]]) + "};\n\n");
+  draw = "0"
+  if compiled:
+    for shift in range(8):
+      writeDrawRoutine(f, name, bitmap, shift)
+    f.write("static const IO_bitmap_draw " + name + "_draw[] = {\n  ")
+    f.write(", ".join([name + "_draw" + str(s) for s in range(8)]) + "};\n\n")
+    draw = name + "_draw"
   f.write("const IO_bitmap " + name + " = {");
   f.write(str(bitmap[0]) + ", " + str(bitmap[1]) + ", " + str(bitmap[2]) + ", ")
-  f.write("(void*)" + name + "_data };\n")
+  f.write("(void*)" + name + "_data, " + draw + " };\n")
 
 #-------------------------------------------------------------------------------
 # Start the show
@@ -65,17 +106,23 @@ def main():
   #-----------------------------------------------------------------------------
   # Print usage
   #-----------------------------------------------------------------------------
-  if len(sys.argv) != 4:
+  args     = sys.argv[1:]
+  compiled = False
+  if args and args[0] == "--compiled":
+    compiled = True
+    args     = args[1:]
+
+  if len(args) != 3:
     print "Usage:"
-    print "   ", sys.argv[0], "bitmap bmp_file output_file"
+    print "   ", sys.argv[0], "[--compiled] bitmap bmp_file output_file"
     return 1
 
   #-----------------------------------------------------------------------------
   # Check the input
   #-----------------------------------------------------------------------------
-  name    = sys.argv[1]
-  bmpfile = sys.argv[2]
-  output  = sys.argv[3]
+  name    = args[0]
+  bmpfile = args[1]
+  output  = args[2]
 
   if not name.isalnum():
     print "Bitmap name may only contain letters and numbers"
@@ -98,11 +145,11 @@ def main():
   # Open the result file and write the data
   #-----------------------------------------------------------------------------
   try:
-    outdir='/'.join(sys.argv[3].split('/')[:-1])
+    outdir='/'.join(output.split('/')[:-1])
     if not os.path.isdir(outdir):
       os.makedirs(outdir)
-    fo = open(sys.argv[3], "w")
-    writeBitmap(fo, name, bmp)
+    fo = open(output, "w")
+    writeBitmap(fo, name, bmp, compiled)
     fo.close()
   except IOError, e:
     print "Error writing to " + output + ":", str(e)
@@ -31,17 +31,22 @@
 uint8_t current_scene = SI_SCENE_INTRO;
 
 struct {
-  SI_scene scene;
+  SI_scene   scene;
+  SI_profile profile;
   void (*cons)(SI_scene *scene);
 } scenes[4];
 
+static const char *scene_names[] = {"intro", "level", "game", "score"};
+
 //------------------------------------------------------------------------------
 // Set active scene
 //------------------------------------------------------------------------------
 void set_active_scene(uint8_t scene)
 {
   IO_disable_interrupts();
+  scenes[current_scene].scene.flags |= SI_SCENE_STOPPED;
   scenes[scene].cons(&scenes[scene].scene);
+  scenes[scene].scene.profile = &scenes[scene].profile;
   IO_enable_interrupts();
   current_scene = scene;
 }
@@ -52,10 +57,8 @@ void set_active_scene(uint8_t scene)
 IO_sys_thread game_thread;
 void game_thread_func()
 {
-  while(1) {
-    SI_scene_render(&scenes[current_scene].scene, &display);
-    IO_sys_sleep(1000/scenes[current_scene].scene.fps);
-  }
+  while(1)
+    IO_sys_sleep(SI_scene_frame(&scenes[current_scene].scene, &display));
 }
 
 //------------------------------------------------------------------------------
@@ -67,6 +70,30 @@ void sound_thread_func()
   IO_sound_player_run(&sound_player);
 }
 
+//------------------------------------------------------------------------------
+// Console thread; send 'p' over the UART to get the frame profiles of all
+// the scenes and the input statistics. The console is buffered, so the thread
+// sleeps until a command arrives and printing does not hold anybody up.
+//------------------------------------------------------------------------------
+IO_sys_thread console_thread;
+void console_thread_func()
+{
+  while(1) {
+    char cmd;
+    if(IO_read(&console, &cmd, 1) != 1 || cmd != 'p')
+      continue;
+    for(int i = 0; i < 4; ++i) {
+      IO_print(&console, "%s: ", scene_names[i]);
+      SI_profile_print(&scenes[i].profile, &console);
+    }
+    SI_input_stats st;
+    SI_input_get_stats(&st);
+    IO_print(&console, "input: %lu events, %lu dropped, latency last/max: "
+             "%lu/%lu ms\r\n", st.events, st.dropped, st.latency_last,
+             st.latency_max);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Start the show
 //------------------------------------------------------------------------------
@@ -81,9 +108,12 @@ int main()
   scenes[SI_SCENE_LEVEL].cons = level_scene_setup;
   scenes[SI_SCENE_GAME].cons  = game_scene_setup;
   scenes[SI_SCENE_SCORE].cons = score_scene_setup;
+  for(int i = 0; i < 4; ++i)
+    SI_profile_init(&scenes[i].profile);
   set_active_scene(SI_SCENE_INTRO);
 
   IO_sys_thread_add(&game_thread,  game_thread_func,  2000, 255);
   IO_sys_thread_add(&sound_thread, sound_thread_func, 1000, 255);
+  IO_sys_thread_add(&console_thread, console_thread_func, 1000, 255);
   IO_sys_run(1000);
 }
@@ -21,9 +21,7 @@
 #include "IO_error.h"
 #include "IO_utils.h"
 
-#include <stdarg.h>
 #include <string.h>
-#include <math.h>
 
 //------------------------------------------------------------------------------
 // Dummu IO initializer
@@ -40,86 +38,334 @@ WEAK_ALIAS(__IO_init, IO_init);
 //------------------------------------------------------------------------------
 int32_t IO_write(IO_io *io, const void *data, uint32_t length)
 {
-  return (*io->write)(io, data, length);
+  if(!io->ops->write)
+    return -IO_ENOSYS;
+  return (*io->ops->write)(io, data, length);
 }
 
 //------------------------------------------------------------------------------
-// Print an unsigned integer to a string; the string buffer needs to be at lease
-// 32 characters long
+// Write a list of chunks to an output device
+//------------------------------------------------------------------------------
+int32_t IO_writev(IO_io *io, const IO_iovec *iov, uint32_t num)
+{
+  if(io->ops->writev)
+    return (*io->ops->writev)(io, iov, num);
+  if(!io->ops->write)
+    return -IO_ENOSYS;
+
+  int32_t written = 0;
+  for(uint32_t i = 0; i < num; ++i) {
+    int32_t ret = (*io->ops->write)(io, iov[i].base, iov[i].length);
+    if(ret < 0)
+      return written ? written : ret;
+    written += ret;
+    if((uint32_t)ret != iov[i].length)
+      break;
+  }
+  return written;
+}
+
+//------------------------------------------------------------------------------
+// Digits; the pairs are used to print two decimal digits at a time
 //------------------------------------------------------------------------------
 static const char digits[] = "0123456789abcdef";
+static const char digit_pairs[] =
+  "0001020304050607080910111213141516171819202122232425262728293031323334"
+  "3536373839404142434445464748495051525354555657585960616263646566676869"
+  "707172737475767778798081828384858687888990919293949596979899";
+
+//------------------------------------------------------------------------------
+// Divide by 10^9 with a reciprocal; 10^9 = 2^9 * 1953125, so after the shift
+// the magic number fits in 64 bits
+//------------------------------------------------------------------------------
+static uint64_t div1e9(uint64_t num)
+{
+  return mulhi64(num >> 9, 0x89705f4136b4a598ULL) >> 20;
+}
+
+//------------------------------------------------------------------------------
+// Print a 32-bit decimal ending just before end, two digits at a time; the
+// divisions by constants compile to multiplications. Returns the start of
+// the number.
+//------------------------------------------------------------------------------
+static char *printDec32(char *end, uint32_t num)
+{
+  while(num >= 100) {
+    uint32_t rem = num % 100;
+    num /= 100;
+    end -= 2;
+    end[0] = digit_pairs[2*rem];
+    end[1] = digit_pairs[2*rem+1];
+  }
+  if(num >= 10) {
+    end -= 2;
+    end[0] = digit_pairs[2*num];
+    end[1] = digit_pairs[2*num+1];
+  }
+  else
+    *--end = '0' + num;
+  return end;
+}
+
+//------------------------------------------------------------------------------
+// Print a 32-bit decimal padded with zeros to nine digits
+//------------------------------------------------------------------------------
+static void printDec9(char *end, uint32_t num)
+{
+  char *start = printDec32(end, num);
+  while(start > end-9)
+    *--start = '0';
+}
+
+//------------------------------------------------------------------------------
+// Print an unsigned integer to a string; the string buffer needs to be at lease
+// 32 characters long. The decimals avoid the 64-bit divisions, which are
+// library calls on the Cortex-M4, by splitting the number into 32-bit chunks
+// of nine digits; the powers of two are done with shifts.
+//------------------------------------------------------------------------------
 static uint32_t printNumStr(char *str, uint64_t num, int base)
 {
   if(base <= 0 || base > 16)
     return 0;
 
-  if(num == 0) {
-    str[0] = '0';
-    return 1;
+  char  buffer[32];
+  char *end    = buffer + sizeof(buffer);
+  char *cursor = end;
+
+  if(base == 10) {
+    if(num >> 32) {
+      uint64_t hi = div1e9(num);
+      printDec9(cursor, num - hi * 1000000000);
+      cursor -= 9;
+      if(hi >> 32) {
+        uint64_t top = div1e9(hi);
+        printDec9(cursor, hi - top * 1000000000);
+        cursor -= 9;
+        hi = top;
+      }
+      num = hi;
+    }
+    cursor = printDec32(cursor, num);
   }
-  uint64_t n = num;
-  uint32_t len = 0;
-  char *cursor1 = str;
-  char *cursor2 = str;
-  while(n && cursor1 != str+31) {
-    int rem = n % base;
-    *cursor1 = digits[rem];
-    n /= base;
-    ++cursor1;
-    ++len;
-  }
-
-  *cursor1 = 0;
-  --cursor1;
-  while(cursor1 > cursor2) {
-    char tmp = *cursor1;
-    *cursor1 = *cursor2;
-    *cursor2 = tmp;
-    --cursor1;
-    ++cursor2;
+
+  else if((base & (base-1)) == 0) {
+    int shift = base == 16 ? 4 : base == 8 ? 3 : base == 4 ? 2 : 1;
+    do {
+      *--cursor = digits[num & (base-1)];
+      num >>= shift;
+    } while(num);
+  }
+
+  else if(num >> 32) {
+    do {
+      *--cursor = digits[num % base];
+      num /= base;
+    } while(num);
+  }
+
+  else {
+    uint32_t n = num;
+    do {
+      *--cursor = digits[n % base];
+      n /= base;
+    } while(n);
   }
+
+  uint32_t len = end - cursor;
+  memcpy(str, cursor, len);
+  str[len] = 0;
   return len;
 }
 
 //------------------------------------------------------------------------------
-// Print unsigned int to an IO device
+// Print a signed integer to a string; the buffer needs to be at least 33
+// characters long
 //------------------------------------------------------------------------------
-static int32_t printNum(IO_io *io, uint64_t num, int base)
+static uint32_t printNumSStr(char *str, int64_t num)
 {
-  char buffer[32];
-  uint32_t len = printNumStr(buffer, num, base);
-  return IO_write(io, buffer, len);
+  if(num < 0) {
+    *str = '-';
+    return printNumStr(str+1, -(uint64_t)num, 10) + 1;
+  }
+  return printNumStr(str, num, 10);
 }
 
 //------------------------------------------------------------------------------
-// Print signed int to an IO device
+// Powers of ten for scaling by a decimal exponent; the factor is put together
+// from the bits of the exponent and applied with a single multiplication or
+// division, which keeps the error down
 //------------------------------------------------------------------------------
-static int32_t printNumS(IO_io *io, int64_t num)
+static const float pow10_float[] = {1e1f, 1e2f, 1e4f, 1e8f, 1e16f, 1e32f};
+static const double pow10_double[] = {
+  1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+
+//------------------------------------------------------------------------------
+// Multiply by 10^exponent in single precision, so that the FPU can do it
+//------------------------------------------------------------------------------
+static float scale10f(float num, int32_t exponent)
 {
-  char buffer[33];
-  char *ptr = buffer;
+  uint32_t e = exponent < 0 ? -exponent : exponent;
+  float factor = 1;
+  for(int i = 0; e && i < 6; ++i, e >>= 1)
+    if(e & 1)
+      factor *= pow10_float[i];
+  if(e)
+    return exponent < 0 ? 0 : num * 1e32f * 1e32f;
+  return exponent < 0 ? num / factor : num * factor;
+}
+
+//------------------------------------------------------------------------------
+// Multiply by 10^exponent in double precision
+//------------------------------------------------------------------------------
+static double scale10(double num, int32_t exponent)
+{
+  uint32_t e = exponent < 0 ? -exponent : exponent;
+  double factor = 1;
+  for(int i = 0; e && i < 9; ++i, e >>= 1)
+    if(e & 1)
+      factor *= pow10_double[i];
+  if(e)
+    return exponent < 0 ? 0 : num * 1e256 * 1e256;
+  return exponent < 0 ? num / factor : num * factor;
+}
+
+//------------------------------------------------------------------------------
+// Print a non-negative number in the fixed notation; the fraction is rounded
+// to the given number of digits, up to 9
+//------------------------------------------------------------------------------
+static uint32_t printFixedStr(char *str, uint32_t integer, uint32_t fraction,
+  uint32_t scale, int precision)
+{
+  if(fraction >= scale) {
+    ++integer;
+    fraction -= scale;
+  }
+
+  uint32_t len = printNumStr(str, integer, 10);
+  if(precision) {
+    str[len++] = '.';
+    for(int i = precision-1; i >= 0; --i) {
+      str[len+i] = digits[fraction % 10];
+      fraction /= 10;
+    }
+    len += precision;
+  }
+  return len;
+}
+
+//------------------------------------------------------------------------------
+// Print a single precision floating point to a string; the buffer needs to
+// be at least 32 characters long. Without the precision, up to 7
+// significant digits are printed, which is all that a float holds, and the
+// exponent is used for the very large and very small numbers. All the
+// arithmetic is in single precision.
+//------------------------------------------------------------------------------
+static uint32_t printFloatStr(char *str, float num, int precision)
+{
+  float numAbs = num < 0 ? -num : num;
   uint32_t len = 0;
+  if(num < 0) str[len++] = '-';
 
-  if(num < 0) {
-    *ptr = '-';
-    ++ptr;
-    num = -num;
-    ++len;
+  //----------------------------------------------------------------------------
+  // Fixed notation with the requested number of fractional digits
+  //----------------------------------------------------------------------------
+  if(precision >= 0 && numAbs < 4000000000.0f) {
+    if(precision > 9) precision = 9;
+    uint32_t scale = 1;
+    for(int i = 0; i < precision; ++i) scale *= 10;
+    uint32_t integer  = (uint32_t)numAbs;
+    uint32_t fraction = (uint32_t)((numAbs-integer) * scale + 0.5f);
+    return len + printFixedStr(str+len, integer, fraction, scale, precision);
+  }
+
+  //----------------------------------------------------------------------------
+  // Numbers that are too large or too small to show 7 significant digits
+  // are normalized to [1, 10) and get the exponent
+  //----------------------------------------------------------------------------
+  int32_t exponent = 0;
+  if(numAbs >= 10000000.0f || (numAbs && numAbs < 0.001f)) {
+    if(numAbs >= 1.0f)
+      for(float p = 10.0f; numAbs >= p && exponent < 38; p *= 10.0f)
+        ++exponent;
+    else
+      for(float p = 1.0f; numAbs < p && exponent > -45; p *= 0.1f)
+        --exponent;
+    numAbs = scale10f(numAbs, -exponent);
+    if(numAbs >= 10.0f) {
+      numAbs /= 10.0f;
+      ++exponent;
+    }
+    else if(numAbs < 1.0f) {
+      numAbs *= 10.0f;
+      --exponent;
+    }
   }
-  len += printNumStr(ptr, num, 10);
-  return IO_write(io, buffer, len);
+
+  //----------------------------------------------------------------------------
+  // Print the significant digits and strip the trailing zeros
+  //----------------------------------------------------------------------------
+  uint32_t integer = (uint32_t)numAbs;
+  int      fdigits = integer ? 6 : 7;
+  uint32_t scale   = integer ? 1000000 : 10000000;
+  for(uint32_t i = integer; i >= 10; i /= 10) {
+    --fdigits;
+    scale /= 10;
+  }
+  if(!integer)
+    for(float p = 0.1f; numAbs < p && fdigits < 9; p *= 0.1f) {
+      ++fdigits;
+      scale *= 10;
+    }
+
+  uint32_t fraction = (uint32_t)((numAbs-integer) * scale + 0.5f);
+  if(exponent && integer == 9 && fraction >= scale) {
+    integer  = 1;
+    fraction = 0;
+    ++exponent;
+  }
+  len += printFixedStr(str+len, integer, fraction, scale, fdigits);
+  while(fdigits && str[len-1] == '0') {
+    --len;
+    --fdigits;
+  }
+  if(fdigits == 0 && str[len-1] == '.')
+    --len;
+
+  if(exponent) {
+    str[len++] = 'e';
+    len += printNumSStr(str+len, exponent);
+  }
+  return len;
 }
 
 //------------------------------------------------------------------------------
-// Print a floating point to an IO device
+// Print a double precision floating point to a string; the buffer needs to be
+// at least 32 characters long. Without the precision, up to 12 significant
+// characters are printed and the exponent is used for the numbers that do
+// not fit.
 //------------------------------------------------------------------------------
-static uint32_t printFloat(IO_io *io, double num)
+static uint32_t printDoubleStr(char *str, double num, int precision)
 {
+  double numAbs = num < 0 ? -num : num;
+  uint32_t len = 0;
+
+  //----------------------------------------------------------------------------
+  // Fixed notation with the requested number of fractional digits
+  //----------------------------------------------------------------------------
+  if(precision >= 0 && numAbs < 1000000000.0) {
+    if(precision > 9) precision = 9;
+    uint32_t scale = 1;
+    for(int i = 0; i < precision; ++i) scale *= 10;
+    uint32_t integer  = (uint32_t)numAbs;
+    uint32_t fraction = (uint32_t)((numAbs-integer) * scale + 0.5);
+    if(num < 0) str[len++] = '-';
+    return len + printFixedStr(str+len, integer, fraction, scale, precision);
+  }
+
   //----------------------------------------------------------------------------
   // Normalize the number
   //----------------------------------------------------------------------------
   int32_t exponent = 0;
-  double numAbs = fabs(num);
   if(numAbs) {
     while(numAbs > 999999999.0) {
       ++exponent;
@@ -135,9 +381,8 @@ static uint32_t printFloat(IO_io *io, double num)
   // Print
   //----------------------------------------------------------------------------
   int32_t integer = (int32_t)numAbs;
-  int32_t len = 0;
-  if(num < 0) len = printNumS(io, -integer);
-  else len = printNumS(io, integer);
+  if(num < 0) str[len++] = '-';
+  len += printNumStr(str+len, integer, 10);
 
   int32_t fraction = (int32_t)((numAbs-integer) * 1000000000.0);
   if(fraction && 12-len > 1) {
@@ -153,110 +398,339 @@ static uint32_t printFloat(IO_io *io, double num)
     for(; buffer[i] == '0'; --i) buffer[i] = 0;
     ++i;
     if(12-len < i) i = 12-len;
-    len += IO_write(io, buffer, i);
+    memcpy(str+len, buffer, i);
+    len += i;
   }
 
   if(exponent) {
-    IO_write(io, "e", 1);
-    len += printNumS(io, exponent);
+    str[len++] = 'e';
+    len += printNumSStr(str+len, exponent);
   }
   return len;
 }
 
+//------------------------------------------------------------------------------
+// Print a Q16.16 fixed point number to a string using only integer arithmetic;
+// 5 fractional digits are printed by default
+//------------------------------------------------------------------------------
+static uint32_t printQ16Str(char *str, IO_q16 num, int precision)
+{
+  uint32_t len = 0;
+  uint32_t mag = num;
+  if(num < 0) {
+    str[len++] = '-';
+    mag = -(uint32_t)num;
+  }
+
+  if(precision < 0) precision = 5;
+  if(precision > 9) precision = 9;
+  uint32_t scale = 1;
+  for(int i = 0; i < precision; ++i) scale *= 10;
+
+  uint32_t fraction = ((uint64_t)(mag & 0xffff) * scale + 0x8000) >> 16;
+  return len + printFixedStr(str+len, mag >> 16, fraction, scale, precision);
+}
+
+//------------------------------------------------------------------------------
+// Output buffer of the formatter; the text is collected on the stack and
+// goes to the device in as few writes as possible
+//------------------------------------------------------------------------------
+#define PRINT_BUFFER_SIZE 64
+
+struct print_buffer {
+  IO_io    *io;
+  int32_t   written;
+  int32_t   error;
+  uint32_t  length;
+  char      data[PRINT_BUFFER_SIZE];
+};
+
+//------------------------------------------------------------------------------
+// Flush the buffer to the device
+//------------------------------------------------------------------------------
+static void print_flush(struct print_buffer *buf)
+{
+  if(!buf->length || buf->error)
+    return;
+
+  int32_t ret = IO_write(buf->io, buf->data, buf->length);
+  if(ret < 0)
+    buf->error = ret;
+  else
+    buf->written += ret;
+  buf->length = 0;
+
+  // the DMA reads the buffer in the background, and we are about to reuse it
+  if(buf->io->flags & IO_DMA)
+    IO_sync(buf->io);
+}
+
+//------------------------------------------------------------------------------
+// Append data to the buffer; chunks that don't fit in are written directly
+//------------------------------------------------------------------------------
+static void print_put(struct print_buffer *buf, const char *data,
+  uint32_t length)
+{
+  if(buf->length + length > PRINT_BUFFER_SIZE) {
+    print_flush(buf);
+    if(length > PRINT_BUFFER_SIZE) {
+      if(buf->error)
+        return;
+      int32_t ret = IO_write(buf->io, data, length);
+      if(ret < 0)
+        buf->error = ret;
+      else
+        buf->written += ret;
+      return;
+    }
+  }
+  memcpy(buf->data + buf->length, data, length);
+  buf->length += length;
+}
+
+//------------------------------------------------------------------------------
+// Append a character repeated count times
+//------------------------------------------------------------------------------
+static void print_fill(struct print_buffer *buf, char chr, int32_t count)
+{
+  while(count > 0) {
+    if(buf->length == PRINT_BUFFER_SIZE)
+      print_flush(buf);
+    buf->data[buf->length++] = chr;
+    --count;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Conversion specification
+//------------------------------------------------------------------------------
+#define PRINT_LEFT 0x01 // left-justify within the field
+#define PRINT_ZERO 0x02 // pad numbers with zeros
+
+struct print_spec {
+  uint8_t flags;
+  int32_t width;
+  int32_t precision;
+};
+
+//------------------------------------------------------------------------------
+// Append a converted value padded to the field width; the zeros go after the
+// sign
+//------------------------------------------------------------------------------
+static void print_field(struct print_buffer *buf, const char *str,
+  uint32_t length, const struct print_spec *spec)
+{
+  int32_t pad = spec->width - length;
+  if(spec->flags & PRINT_LEFT) {
+    print_put(buf, str, length);
+    print_fill(buf, ' ', pad);
+  }
+  else if(spec->flags & PRINT_ZERO) {
+    if(length && *str == '-') {
+      print_put(buf, str, 1);
+      ++str;
+      --length;
+    }
+    print_fill(buf, '0', pad);
+    print_put(buf, str, length);
+  }
+  else {
+    print_fill(buf, ' ', pad);
+    print_put(buf, str, length);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Print formated string to an IO device
 //------------------------------------------------------------------------------
 int32_t IO_print(IO_io *io, const char *format, ...)
 {
   va_list ap;
-  int length  = 0;
-  int sz      = 0;
-  int base    = 0;
-  int sgn     = 0;
-  int fl      = 0;
-  int ret     = 0;
-  int written = 0;
+  va_start(ap, format);
+  int32_t ret = IO_vprint(io, format, ap);
+  va_end(ap);
+  return ret;
+}
+
+//------------------------------------------------------------------------------
+// Print formated string to an IO device, the arguments come in a list
+//------------------------------------------------------------------------------
+int32_t IO_vprint(IO_io *io, const char *format, va_list ap)
+{
+  struct print_buffer buf;
+  buf.io      = io;
+  buf.written = 0;
+  buf.error   = 0;
+  buf.length  = 0;
+
   const char *cursor = format;
   const char *start  = format;
 
-  va_start(ap, format);
-  while(*cursor) {
-    if(*cursor == '%') {
-      ret = IO_write(io, start, length);
-      if(ret < 0) return ret;
-      written += ret;
+  while(*cursor && !buf.error) {
+    if(*cursor != '%') {
       ++cursor;
-      if(*cursor == 0)
-        break;
-
-      if(*cursor == 's') {
-        const char *str = va_arg(ap, const char*);
-        ret = IO_write(io, str, strlen(str));
-        if(ret < 0) return ret;
-        written += ret;
-      }
+      continue;
+    }
 
-      else {
-        while(*cursor == 'l') {
-          ++sz;
-          ++cursor;
-        }
-        if(sz > 2) sz = 2;
-
-        if(*cursor == 'x')
-          base = 16;
-        else if(*cursor == 'u')
-          base = 10;
-        else if(*cursor == 'o')
-          base = 8;
-        else if(*cursor == 'd')
-          sgn  = 1;
-        else if(*cursor == 'f')
-          fl   = 1;
-
-        if(fl) {
-          double num;
-          if(sz <= 1) num = va_arg(ap, double);
-          else num = va_arg(ap, long double);
-          ret = printFloat(io, num);
-          if(ret < 0) return ret;
-          written += ret;
-        }
-        else if(!sgn) {
-          uint64_t num;
-          if(sz == 0) num = va_arg(ap, unsigned);
-          else if(sz == 1) num = va_arg(ap, unsigned long);
-          else num = va_arg(ap, unsigned long long);
-          ret = printNum(io, num, base);
-          if(ret < 0) return ret;
-          written += ret;
-        }
-        else {
-          int64_t num;
-          if(sz == 0) num = va_arg(ap, int);
-          else if(sz == 1) num = va_arg(ap, long);
-          else num = va_arg(ap, long long);
-          ret = printNumS(io, num);
-          if(ret < 0) return ret;
-          written += ret;
-        }
-        sz = 0; base = 0; sgn = 0;
-      }
+    print_put(&buf, start, cursor-start);
+    ++cursor;
+    if(*cursor == 0)
+      break;
+
+    //--------------------------------------------------------------------------
+    // Parse the flags, the width, the precision and the size
+    //--------------------------------------------------------------------------
+    struct print_spec spec = {0, 0, -1};
+    for(;; ++cursor) {
+      if(*cursor == '-') spec.flags |= PRINT_LEFT;
+      else if(*cursor == '0') spec.flags |= PRINT_ZERO;
+      else break;
+    }
+
+    while(*cursor >= '0' && *cursor <= '9')
+      spec.width = spec.width*10 + *cursor++ - '0';
+
+    if(*cursor == '.') {
       ++cursor;
-      start = cursor;
-      length = 0;
-      continue;
+      spec.precision = 0;
+      while(*cursor >= '0' && *cursor <= '9')
+        spec.precision = spec.precision*10 + *cursor++ - '0';
     }
-    ++length;
+
+    int sz = 0;
+    while(*cursor == 'l') {
+      ++sz;
+      ++cursor;
+    }
+    if(sz > 2) sz = 2;
+
+    //--------------------------------------------------------------------------
+    // Convert
+    //--------------------------------------------------------------------------
+    char     str[34];
+    uint32_t len  = 0;
+    int      base = 0;
+
+    if(*cursor == '%')
+      print_put(&buf, cursor, 1);
+
+    else if(*cursor == 's') {
+      const char *s = va_arg(ap, const char*);
+      len = strlen(s);
+      if(spec.precision >= 0 && (uint32_t)spec.precision < len)
+        len = spec.precision;
+      spec.flags &= ~PRINT_ZERO;
+      print_field(&buf, s, len, &spec);
+    }
+
+    else if(*cursor == 'c') {
+      str[0] = va_arg(ap, int);
+      spec.flags &= ~PRINT_ZERO;
+      print_field(&buf, str, 1, &spec);
+    }
+
+    else if(*cursor == 'f') {
+      double num = va_arg(ap, double);
+      if(sz == 0) len = printFloatStr(str, num, spec.precision);
+      else len = printDoubleStr(str, num, spec.precision);
+      print_field(&buf, str, len, &spec);
+    }
+
+    else if(*cursor == 'k') {
+      IO_q16 num = va_arg(ap, IO_q16);
+      len = printQ16Str(str, num, spec.precision);
+      print_field(&buf, str, len, &spec);
+    }
+
+    else if(*cursor == 'd') {
+      int64_t num;
+      if(sz == 0) num = va_arg(ap, int);
+      else if(sz == 1) num = va_arg(ap, long);
+      else num = va_arg(ap, long long);
+      len = printNumSStr(str, num);
+      print_field(&buf, str, len, &spec);
+    }
+
+    else {
+      if(*cursor == 'x') base = 16;
+      else if(*cursor == 'u') base = 10;
+      else if(*cursor == 'o') base = 8;
+
+      uint64_t num;
+      if(sz == 0) num = va_arg(ap, unsigned);
+      else if(sz == 1) num = va_arg(ap, unsigned long);
+      else num = va_arg(ap, unsigned long long);
+      len = printNumStr(str, num, base);
+      print_field(&buf, str, len, &spec);
+    }
+
     ++cursor;
+    start = cursor;
   }
-  if(length) {
-    ret = IO_write(io, start, length);
-    if(ret < 0) return ret;
-    written += ret;
-  }
-  va_end (ap);
-  return written;
+  if(!buf.error)
+    print_put(&buf, start, cursor-start);
+  print_flush(&buf);
+
+  if(buf.error && !buf.written)
+    return buf.error;
+  return buf.written;
+}
+
+//------------------------------------------------------------------------------
+// Write to an in-memory sink; whatever does not fit is dropped
+//------------------------------------------------------------------------------
+static int32_t membuf_write(IO_io *io, const void *data, uint32_t length)
+{
+  IO_membuf *membuf = (IO_membuf *)io;
+  if(!membuf->size)
+    return length;
+
+  uint32_t space = membuf->size - 1 - membuf->length;
+  uint32_t len   = length < space ? length : space;
+  memcpy(membuf->data + membuf->length, data, len);
+  membuf->length += len;
+  membuf->data[membuf->length] = 0;
+  return length;
+}
+
+static const IO_ops membuf_ops = { membuf_write, 0, 0, 0, 0, 0 };
+
+//------------------------------------------------------------------------------
+// Initialize an in-memory sink
+//------------------------------------------------------------------------------
+int32_t IO_membuf_init(IO_membuf *membuf, char *data, uint32_t size)
+{
+  if(!membuf || (size && !data))
+    return -IO_EINVAL;
+
+  membuf->io.type    = IO_MEMBUF;
+  membuf->io.channel = 0;
+  membuf->io.flags   = 0;
+  membuf->io.ops     = &membuf_ops;
+  membuf->io.event   = 0;
+  membuf->data       = data;
+  membuf->size       = size;
+  membuf->length     = 0;
+  if(size)
+    data[0] = 0;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Print formated string to a string
+//------------------------------------------------------------------------------
+int32_t IO_snprintf(char *str, uint32_t size, const char *format, ...)
+{
+  IO_membuf membuf;
+  int32_t ret = IO_membuf_init(&membuf, str, size);
+  if(ret)
+    return ret;
+
+  va_list ap;
+  va_start(ap, format);
+  ret = IO_vprint(&membuf.io, format, ap);
+  va_end(ap);
+  return ret;
 }
 
 //------------------------------------------------------------------------------
@@ -264,7 +738,9 @@ int32_t IO_print(IO_io *io, const char *format, ...)
 //------------------------------------------------------------------------------
 int32_t IO_read(IO_io *io, void *data, uint32_t length)
 {
-  return (*io->read)(io, data, length);
+  if(!io->ops->read)
+    return -IO_ENOSYS;
+  return (*io->ops->read)(io, data, length);
 }
 
 //------------------------------------------------------------------------------
@@ -344,6 +820,7 @@ int check_chars(const char *data, uint8_t type, uint8_t base)
   int minuses = 0;
   int es = 0;
   int dots = 0;
+  int real = type == IO_DOUBLE || type == IO_FLOAT;
 
   for(const char *cursor = data; *cursor; ++cursor) {
 
@@ -353,11 +830,11 @@ int check_chars(const char *data, uint8_t type, uint8_t base)
     if(*cursor == '-') {
       ++minuses;
 
-      if(type == IO_INT32 && minuses == 1 && cursor == data &&
-         is_digit(*(cursor+1), base))
+      if((type == IO_INT32 || type == IO_Q16) && minuses == 1 &&
+         cursor == data && is_digit(*(cursor+1), base))
         continue;
 
-      if(type == IO_DOUBLE && minuses <= 2) {
+      if(real && minuses <= 2) {
         if(cursor == data && is_digit(*(cursor+1), base))
           continue;
         if(*(cursor-1) == 'e' && is_digit(*(cursor+1), base))
@@ -370,7 +847,7 @@ int check_chars(const char *data, uint8_t type, uint8_t base)
     //--------------------------------------------------------------------------
     else if(*cursor == 'e') {
       ++es;
-      if(type == IO_DOUBLE && cursor != data && es == 1)
+      if(real && cursor != data && es == 1)
         continue;
     }
 
@@ -379,7 +856,7 @@ int check_chars(const char *data, uint8_t type, uint8_t base)
     //--------------------------------------------------------------------------
     else if(*cursor == '.') {
       ++dots;
-      if(type == IO_DOUBLE && cursor != data && dots == 1 &&
+      if((real || type == IO_Q16) && cursor != data && dots == 1 &&
          is_digit(*(cursor-1), base) && is_digit(*(cursor+1), base))
         continue;
     }
@@ -456,58 +933,106 @@ void parse_int32(int32_t *result, char *buffer)
 }
 
 //------------------------------------------------------------------------------
-// Parse double
+// Split a decimal real number into a mantissa and an exponent; the digits
+// that don't fit in the mantissa only adjust the exponent
 //------------------------------------------------------------------------------
-void parse_double(double *result, char *buffer)
+static void parse_decimal(const char *buffer, uint64_t limit, int *negative,
+  uint64_t *mantissa, int32_t *exponent)
 {
-  *result = 0;
-  //----------------------------------------------------------------------------
-  // Find the parts
-  //----------------------------------------------------------------------------
-  char *integer = buffer;
-  char *fraction = 0;
-  char *exponent = 0;
-  int32_t len = strlen(buffer);
-  for(int i = 0; i < len; ++i) {
-    if(buffer[i] == '.') {
-      buffer[i] = 0;
-      fraction = buffer+i+1;
+  *negative = 0;
+  *mantissa = 0;
+  *exponent = 0;
+
+  if(*buffer == '-') {
+    *negative = 1;
+    ++buffer;
+  }
+
+  int fraction = 0;
+  for(; *buffer && *buffer != 'e'; ++buffer) {
+    if(*buffer == '.') {
+      fraction = 1;
+      continue;
     }
-    else if(buffer[i] == 'e') {
-      buffer[i] = 0;
-      exponent = buffer+i+1;
+    if(*mantissa < limit) {
+      *mantissa = *mantissa * 10 + (*buffer - '0');
+      if(fraction)
+        --*exponent;
     }
+    else if(!fraction)
+      ++*exponent;
   }
 
-  //----------------------------------------------------------------------------
-  // Convert the parts
-  //----------------------------------------------------------------------------
-  int64_t  i_integer;
-  uint64_t i_fraction = 0;
-  uint32_t l_fraction = strlen(fraction);
-  int64_t  i_exponent = 0;
+  if(*buffer == 'e') {
+    int32_t e;
+    parse_int32(&e, (char *)buffer+1);
+    *exponent += e;
+  }
+}
 
-  parse_int64(&i_integer, integer);
-  if(fraction)
-    parse_uint64(&i_fraction, fraction, 10);
-  if(exponent)
-    parse_int64(&i_exponent, exponent);
+//------------------------------------------------------------------------------
+// Parse double; the mantissa is scaled by the powers of ten at once instead of
+// multiplying by ten in a loop
+//------------------------------------------------------------------------------
+void parse_double(double *result, char *buffer)
+{
+  int      negative;
+  uint64_t mantissa;
+  int32_t  exponent;
+  parse_decimal(buffer, 100000000000000000ULL, &negative, &mantissa,
+                &exponent);
+  double d = scale10(mantissa, exponent);
+  *result = negative ? -d : d;
+}
 
-  //----------------------------------------------------------------------------
-  // Put everything together
-  //----------------------------------------------------------------------------
-  double d = i_integer;
-  double df = i_fraction;
-  for(int i = 0; i < l_fraction; ++i)
-    df /= 10.0;
-  d += df;
-  if(i_exponent > 0)
-    for(int i = 0; i < i_exponent; ++i)
-      d *= 10.0;
-  else
-    for(int i = 0; i > i_exponent; --i)
-      d /= 10.0;
-  *result = d;
+//------------------------------------------------------------------------------
+// Parse float; the mantissa fits in 32 bits and everything else happens in
+// single precision
+//------------------------------------------------------------------------------
+void parse_float(float *result, char *buffer)
+{
+  int      negative;
+  uint64_t mantissa;
+  int32_t  exponent;
+  parse_decimal(buffer, 100000000, &negative, &mantissa, &exponent);
+  float f = scale10f((uint32_t)mantissa, exponent);
+  *result = negative ? -f : f;
+}
+
+//------------------------------------------------------------------------------
+// Parse a Q16.16 fixed point number; the fraction is converted to binary by
+// long division, one bit at a time, and rounded
+//------------------------------------------------------------------------------
+void parse_q16(IO_q16 *result, char *buffer)
+{
+  int negative = 0;
+  if(*buffer == '-') {
+    negative = 1;
+    ++buffer;
+  }
+
+  uint32_t integer = 0;
+  for(; *buffer && *buffer != '.'; ++buffer)
+    integer = integer * 10 + (*buffer - '0');
+
+  uint32_t fraction = 0;
+  uint32_t scale    = 1;
+  if(*buffer == '.')
+    for(++buffer; *buffer && scale < 1000000000; ++buffer, scale *= 10)
+      fraction = fraction * 10 + (*buffer - '0');
+
+  uint32_t bits = 0;
+  for(int i = 0; i < 17; ++i) {
+    fraction <<= 1;
+    bits <<= 1;
+    if(fraction >= scale) {
+      fraction -= scale;
+      bits |= 1;
+    }
+  }
+
+  uint32_t q = (integer << 16) + ((bits + 1) >> 1);
+  *result = negative ? -(int32_t)q : (int32_t)q;
 }
 
 //------------------------------------------------------------------------------
@@ -515,7 +1040,7 @@ void parse_double(double *result, char *buffer)
 //------------------------------------------------------------------------------
 int32_t IO_scan(IO_io *io, uint8_t type, void *data, uint32_t param)
 {
-  if(type > IO_DOUBLE)
+  if(type > IO_Q16)
     return -IO_EINVAL;
 
   if(type == IO_STRING)
@@ -550,6 +1075,16 @@ int32_t IO_scan(IO_io *io, uint8_t type, void *data, uint32_t param)
         return -IO_EINVAL;
       parse_double(data, buffer);
       break;
+    case IO_FLOAT:
+      if(!check_chars(buffer, IO_FLOAT, 10))
+        return -IO_EINVAL;
+      parse_float(data, buffer);
+      break;
+    case IO_Q16:
+      if(!check_chars(buffer, IO_Q16, 10))
+        return -IO_EINVAL;
+      parse_q16(data, buffer);
+      break;
   }
   return ret;
 }
@@ -557,27 +1092,31 @@ int32_t IO_scan(IO_io *io, uint8_t type, void *data, uint32_t param)
 //------------------------------------------------------------------------------
 // Enable events on IO device
 //------------------------------------------------------------------------------
-int32_t __IO_event_enable(IO_io *io, uint16_t events)
+int32_t IO_event_enable(IO_io *io, uint16_t events)
 {
-  return -IO_ENOSYS;
+  if(!io->ops->event_enable)
+    return -IO_ENOSYS;
+  return io->ops->event_enable(io, events);
 }
-WEAK_ALIAS(__IO_event_enable, IO_event_enable);
 
 //------------------------------------------------------------------------------
 // Disable events on IO device
 //------------------------------------------------------------------------------
-int32_t __IO_event_disable(IO_io *io, uint16_t events)
+int32_t IO_event_disable(IO_io *io, uint16_t events)
 {
-  return -IO_ENOSYS;
+  if(!io->ops->event_disable)
+    return -IO_ENOSYS;
+  return io->ops->event_disable(io, events);
 }
-WEAK_ALIAS(__IO_event_disable, IO_event_disable);
 
 //------------------------------------------------------------------------------
 // Sync
 //------------------------------------------------------------------------------
 uint32_t IO_sync(IO_io *io)
 {
-  return io->sync(io);
+  if(!io->ops->sync)
+    return -IO_ENOSYS;
+  return io->ops->sync(io);
 }
 
 //------------------------------------------------------------------------------
@@ -611,6 +1150,26 @@ uint64_t __IO_time()
 
 WEAK_ALIAS(__IO_time, IO_time);
 
+//------------------------------------------------------------------------------
+// Get time in nanoseconds
+//------------------------------------------------------------------------------
+uint64_t __IO_time_ns()
+{
+  return 0;
+}
+
+WEAK_ALIAS(__IO_time_ns, IO_time_ns);
+
+//------------------------------------------------------------------------------
+// Get time in clock cycles
+//------------------------------------------------------------------------------
+uint64_t __IO_time_cycles()
+{
+  return 0;
+}
+
+WEAK_ALIAS(__IO_time_cycles, IO_time_cycles);
+
 //------------------------------------------------------------------------------
 // RNG
 //------------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdarg.h>
 
 //------------------------------------------------------------------------------
 // IO flags
@@ -27,6 +28,7 @@
 #define IO_NONBLOCKING 0x0001
 #define IO_ASYNC       0x0002
 #define IO_DMA         0x0004
+#define IO_BUFFERED    0x0008
 
 //------------------------------------------------------------------------------
 //! Initialize the IO modules
@@ -44,6 +46,7 @@ int32_t IO_init(uint32_t stack_size);
 #define IO_ADC     6
 #define IO_DAC     7
 #define IO_SOUND   8
+#define IO_MEMBUF  9
 
 //------------------------------------------------------------------------------
 // IO events
@@ -57,13 +60,41 @@ int32_t IO_init(uint32_t stack_size);
 #define IO_EVENT_DONE      0x0010
 
 //------------------------------------------------------------------------------
-//! IO definition
+//! A chunk of data for the vectored writes
 //------------------------------------------------------------------------------
-struct IO_io {
+struct IO_iovec {
+  const void *base;     //!< start of the data
+  uint32_t    length;   //!< length in the units of the device's write
+};
+
+typedef struct IO_iovec IO_iovec;
+
+struct IO_io;
+
+//------------------------------------------------------------------------------
+//! Device operations
+//!
+//! The drivers keep one constant table for every kind of device they handle
+//! and the devices point to it. Any of the functions may be missing: IO_writev
+//! falls back to write, and the other calls fail with -IO_ENOSYS.
+//------------------------------------------------------------------------------
+struct IO_ops {
   int32_t (*write)(struct IO_io *io, const void *data, uint32_t length);
+  int32_t (*writev)(struct IO_io *io, const IO_iovec *iov, uint32_t num);
   int32_t (*read)(struct IO_io *io, void *data, uint32_t length);
-  void (*event)(struct IO_io *io, uint16_t event);
   int32_t (*sync)(struct IO_io *io);
+  int32_t (*event_enable)(struct IO_io *io, uint16_t events);
+  int32_t (*event_disable)(struct IO_io *io, uint16_t events);
+};
+
+typedef struct IO_ops IO_ops;
+
+//------------------------------------------------------------------------------
+//! IO definition
+//------------------------------------------------------------------------------
+struct IO_io {
+  const IO_ops *ops;
+  void (*event)(struct IO_io *io, uint16_t event); //!< set by the user
   uint16_t flags;
   uint8_t  type;
   uint8_t  channel;
@@ -76,11 +107,77 @@ typedef struct IO_io IO_io;
 //------------------------------------------------------------------------------
 int32_t IO_write(IO_io *io, const void *data, uint32_t length);
 
+//------------------------------------------------------------------------------
+//! Write a list of chunks to an IO device
+//!
+//! Devices that can do so send everything in one go, ie. in a single DMA
+//! scatter-gather chain; others get a write for every chunk.
+//!
+//! @param io  the io device
+//! @param iov the chunks
+//! @param num number of the chunks
+//! @return    number of units written or an error if nothing could be written
+//------------------------------------------------------------------------------
+int32_t IO_writev(IO_io *io, const IO_iovec *iov, uint32_t num);
+
 //------------------------------------------------------------------------------
 //! Print to an IO device - similar to printf
+//!
+//! Supports the d, u, x, o, f, k, c, s and % conversions with the l and ll
+//! sizes, the field width, the - and 0 flags, and the precision for f and k
+//! (fractional digits) and s (maximum length). The output is collected in
+//! a small buffer on the stack and written out in as few writes as possible.
+//!
+//! %f is formatted in single precision, so that the FPU can do the work,
+//! %lf in double precision. %k prints a Q16.16 fixed point number (IO_q16).
+//!
+//! @return number of bytes written or an error if nothing could be written
 //------------------------------------------------------------------------------
 int32_t IO_print(IO_io *io, const char *format, ...);
 
+//------------------------------------------------------------------------------
+//! Print to an IO device - similar to vprintf
+//------------------------------------------------------------------------------
+int32_t IO_vprint(IO_io *io, const char *format, va_list ap);
+
+//------------------------------------------------------------------------------
+//! In-memory sink
+//!
+//! Collects whatever is written to it in a buffer and keeps it
+//! null-terminated. The data that does not fit is dropped but still counted
+//! as written, so a formatter can tell how long the full output would have
+//! been.
+//------------------------------------------------------------------------------
+struct IO_membuf {
+  IO_io     io;       //!< the device, needs to be the first member
+  char     *data;     //!< the buffer
+  uint32_t  size;     //!< size of the buffer
+  uint32_t  length;   //!< number of bytes stored, without the terminator
+};
+
+typedef struct IO_membuf IO_membuf;
+
+//------------------------------------------------------------------------------
+//! Initialize an in-memory sink
+//!
+//! @param membuf the sink
+//! @param data   the buffer
+//! @param size   size of the buffer including the space for the terminator
+//! @return       0 on success, < 0 on error
+//------------------------------------------------------------------------------
+int32_t IO_membuf_init(IO_membuf *membuf, char *data, uint32_t size);
+
+//------------------------------------------------------------------------------
+//! Print to a string - similar to snprintf
+//!
+//! The output is truncated to size-1 characters and always null-terminated
+//! when size is not zero.
+//!
+//! @return length of the full output, the output has been truncated if it
+//!         is size or more
+//------------------------------------------------------------------------------
+int32_t IO_snprintf(char *str, uint32_t size, const char *format, ...);
+
 //------------------------------------------------------------------------------
 //! Read from and IO device
 //------------------------------------------------------------------------------
@@ -95,6 +192,15 @@ int32_t IO_read(IO_io *io, void *data, uint32_t length);
 #define IO_UINT32 3
 #define IO_UINT64 4
 #define IO_DOUBLE 5
+#define IO_FLOAT  6
+#define IO_Q16    7
+
+//------------------------------------------------------------------------------
+//! Q16.16 fixed point number
+//------------------------------------------------------------------------------
+typedef int32_t IO_q16;
+
+#define IO_Q16_ONE 65536
 
 //------------------------------------------------------------------------------
 //! Read and parse data from the input
@@ -103,7 +209,9 @@ int32_t IO_read(IO_io *io, void *data, uint32_t length);
 //! @param type  type of data to by read
 //! @param data  buffer for the data
 //! @param param length of the buffer when IO_STRING is requested or base
-//!              of the integer when an IO_UINT type is requested
+//!              of the integer when an IO_UINT type is requested; IO_FLOAT
+//!              is parsed in single precision and IO_Q16 with integer
+//!              arithmetic only
 //! @return      number of bytes read from the device or an error
 //------------------------------------------------------------------------------
 int32_t IO_scan(IO_io *io, uint8_t type, void *data, uint32_t param);
@@ -131,14 +239,31 @@ int32_t IO_event_disable(IO_io *io, uint16_t events);
 //------------------------------------------------------------------------------
 uint32_t IO_sync(IO_io *io);
 
+//------------------------------------------------------------------------------
+//! Compiled bitmap drawing routine
+//!
+//! Overwrites the box of the bitmap in a framebuffer organized in pages of
+//! stride bytes (see IO_framebuffer); pixels points to the byte holding the
+//! top-left corner of the box. No clipping is done.
+//------------------------------------------------------------------------------
+typedef void (*IO_bitmap_draw)(uint8_t *pixels, uint16_t stride);
+
 //------------------------------------------------------------------------------
 //! Bitmap
+//!
+//! The data is stored in packed columns. Each column consists of
+//! (height+7)/8 bytes; each byte holds 8 rows with the top-most row in the
+//! least significant bit and a set bit marks the ink.
+//!
+//! Bitmaps known at build time may come with compiled drawing routines, one
+//! for each offset of the top row within a framebuffer page.
 //------------------------------------------------------------------------------
 struct IO_bitmap {
   uint16_t  width;   //!< width
   uint16_t  height;  //!< height
   uint8_t   bpp;     //!< bits per pixel
-  void     *data;    //!< flattened data
+  void     *data;    //!< packed columns
+  const IO_bitmap_draw *draw; //!< compiled routines for y%8, may be null
 };
 
 typedef struct IO_bitmap IO_bitmap;
@@ -154,10 +279,23 @@ int32_t IO_set(IO_io *io, uint64_t data);
 int32_t IO_get(IO_io *io, uint64_t *data);
 
 //------------------------------------------------------------------------------
-//! Get time
+//! Get time in miliseconds since the system start
 //------------------------------------------------------------------------------
 uint64_t IO_time();
 
+//------------------------------------------------------------------------------
+//! Get time in nanoseconds since the system start
+//!
+//! The clock is monotonic and free-running; the resolution is one clock cycle
+//------------------------------------------------------------------------------
+uint64_t IO_time_ns();
+
+//------------------------------------------------------------------------------
+//! Get the number of clock cycles since the system start; IO_profiler_frequency
+//! gives the number of cycles per second
+//------------------------------------------------------------------------------
+uint64_t IO_time_cycles();
+
 //------------------------------------------------------------------------------
 //! Seed the RNG
 //------------------------------------------------------------------------------
@@ -41,6 +41,16 @@ int32_t __IO_timer_init(IO_io *io, uint8_t module)
 
 WEAK_ALIAS(__IO_timer_init, IO_timer_init);
 
+//------------------------------------------------------------------------------
+// Initialize a periodic timer
+//------------------------------------------------------------------------------
+int32_t __IO_timer_init_periodic(IO_io *io, uint8_t module, uint64_t period)
+{
+  return -IO_ENOSYS;
+}
+
+WEAK_ALIAS(__IO_timer_init_periodic, IO_timer_init_periodic);
+
 //------------------------------------------------------------------------------
 // Dummy SSI initializer
 //------------------------------------------------------------------------------
@@ -72,6 +82,26 @@ int32_t __IO_gpio_init(IO_io *io, uint8_t pin, uint16_t flags, uint8_t dir)
 
 WEAK_ALIAS(__IO_gpio_init, IO_gpio_init);
 
+//------------------------------------------------------------------------------
+// Debounce a GPIO input
+//------------------------------------------------------------------------------
+int32_t __IO_gpio_debounce(IO_io *io, uint16_t window)
+{
+  return -IO_ENOSYS;
+}
+
+WEAK_ALIAS(__IO_gpio_debounce, IO_gpio_debounce);
+
+//------------------------------------------------------------------------------
+// Get the time of the last debounced change
+//------------------------------------------------------------------------------
+uint64_t __IO_gpio_timestamp(IO_io *io)
+{
+  return 0;
+}
+
+WEAK_ALIAS(__IO_gpio_timestamp, IO_gpio_timestamp);
+
 //------------------------------------------------------------------------------
 // Initialize a button
 //------------------------------------------------------------------------------
@@ -31,6 +31,26 @@
 //------------------------------------------------------------------------------
 int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud);
 
+//------------------------------------------------------------------------------
+//! Open an UART device in the buffered mode
+//!
+//! The data is queued in ring buffers that the interrupt handler drains to
+//! and fills from the hardware. Writes return as soon as the data is queued
+//! and block only when the TX buffer is full; blocking reads sleep until
+//! enough data arrives. Blocking needs the threads to be running. Bytes
+//! received while the RX buffer is full are dropped. IO_uart_init with the
+//! IO_BUFFERED flag uses the default buffer sizes.
+//!
+//! @param io      the io structure to be initialized
+//! @param module  UART module number to be configured
+//! @param flags   flags
+//! @param baud    baud rate of the device
+//! @param tx_size size of the transmit buffer
+//! @param rx_size size of the receive buffer
+//------------------------------------------------------------------------------
+int32_t IO_uart_init_buffered(IO_io *io, uint8_t module, uint16_t flags,
+  uint32_t baud, uint16_t tx_size, uint16_t rx_size);
+
 //------------------------------------------------------------------------------
 //! Initialize a timer
 //!
@@ -39,6 +59,19 @@ int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud);
 //------------------------------------------------------------------------------
 int32_t IO_timer_init(IO_io *io, uint8_t module);
 
+//------------------------------------------------------------------------------
+//! Initialize a periodic timer
+//!
+//! The timer reloads itself in hardware and fires IO_EVENT_TICK every period.
+//! Setting the timer changes the period starting from the next tick, setting
+//! it to 0 stops it.
+//!
+//! @param io     the io structure to be initialized
+//! @param module number of a timer device to be configured
+//! @param period period in nanoseconds, 0 to leave the timer stopped
+//------------------------------------------------------------------------------
+int32_t IO_timer_init_periodic(IO_io *io, uint8_t module, uint64_t period);
+
 //------------------------------------------------------------------------------
 // SSI frame formats
 //------------------------------------------------------------------------------
@@ -90,6 +123,24 @@ int32_t IO_led_init(IO_io *io, uint8_t module);
 //------------------------------------------------------------------------------
 int32_t IO_gpio_init(IO_io *io, uint8_t pin, uint16_t flags, uint8_t dir);
 
+//------------------------------------------------------------------------------
+//! Debounce a GPIO input initialized with IO_ASYNC
+//!
+//! The first edge masks the pin interrupt, and the pin is sampled again once
+//! the window has passed. The IO_EVENT_CHANGE event fires only if the sampled
+//! state differs from the last one, and reads return the debounced state.
+//!
+//! @param io     the GPIO
+//! @param window length of the window in miliseconds
+//------------------------------------------------------------------------------
+int32_t IO_gpio_debounce(IO_io *io, uint16_t window);
+
+//------------------------------------------------------------------------------
+//! Get the time, in miliseconds, of the first edge of the last debounced
+//! change; 0 if the pin is not debounced
+//------------------------------------------------------------------------------
+uint64_t IO_gpio_timestamp(IO_io *io);
+
 //------------------------------------------------------------------------------
 //! Initialize a button, returns the appropriate GPIO
 //!
@@ -108,9 +159,43 @@ int32_t IO_button_init(IO_io *io, uint8_t module, uint16_t flags);
 //------------------------------------------------------------------------------
 int32_t IO_adc_init(IO_io *io, uint8_t module, uint16_t flags);
 
+//------------------------------------------------------------------------------
+//! Continuous ADC sampling attributes
+//------------------------------------------------------------------------------
+struct IO_adc_attrs {
+  uint8_t  inputs[8];   //!< analog inputs sampled by one sequence
+  uint8_t  num_inputs;  //!< number of inputs in the sequence
+  uint8_t  oversample;  //!< average 2^oversample conversions in hardware, up
+                        //!< to 6; shared by all the sequencers of the ADC
+  uint8_t  timer;       //!< the timer module triggering the sequence
+  uint16_t depth;       //!< number of sequences in each half of the ring
+  uint64_t period;      //!< sampling period in nanoseconds
+};
+
+typedef struct IO_adc_attrs IO_adc_attrs;
+
+//------------------------------------------------------------------------------
+//! Initialize an ADC sequencer sampling continuously
+//!
+//! A timer triggers the sequence every period and the DMA moves the results
+//! to a ring buffer, so there is no interrupt per sample. Reads return the
+//! latest complete sequence, one value per input, without blocking. The
+//! IO_EVENT_DONE event fires every time half of the ring has been filled.
+//!
+//! @param io     the io structure to be initialized
+//! @param module number of the ADC sequencer to be configured
+//! @param flags  flags
+//! @param attrs  the sampling attributes
+//------------------------------------------------------------------------------
+int32_t IO_adc_init_continuous(IO_io *io, uint8_t module, uint16_t flags,
+  const IO_adc_attrs *attrs);
+
 //------------------------------------------------------------------------------
 //! Initialize a slider
 //!
+//! With IO_BUFFERED, the slider is sampled continuously in the background and
+//! IO_get returns the latest value.
+//!
 //! @param io     the io structure to be initialized
 //! @param module number of the ADC device to be configured
 //! @param flags  flags
@@ -38,6 +38,7 @@ struct display {
   uint16_t space_width;
   uint16_t x;
   uint16_t y;
+  IO_ops   ops;   // the operations of the device with the text output added
 };
 
 typedef struct display display;
@@ -71,16 +72,19 @@ static int32_t display_write(IO_io *io, const void *data, uint32_t length)
       continue;
     }
 
-    const IO_bitmap *bmp = IO_font_get_glyph(dsp->font, text[i]);
-    if(dsp->x + bmp->width > dsp->width) {
+    const IO_font *font = dsp->font;
+    uint8_t glyph = IO_font_get_glyph(text[i]);
+    uint8_t width = font->advance[glyph];
+    if(dsp->x + width > dsp->width) {
       dsp->x = 0;
       dsp->y += dsp->line_height;
     }
-    if(dsp->y + bmp->height > dsp->height)
+    if(dsp->y + font->size > dsp->height)
       break;
 
-    IO_display_print_bitmap(io, dsp->x, dsp->y, bmp);
-    dsp->x += bmp->width;
+    IO_display_blit_low(io, dsp->x, dsp->y, width, font->size,
+                        font->strip + font->offset[glyph]);
+    dsp->x += width;
   }
   return i;
 }
@@ -127,8 +131,10 @@ int32_t IO_display_init(IO_io *io, uint8_t module)
   //----------------------------------------------------------------------------
   // Add read and write functions
   //----------------------------------------------------------------------------
-  io->read  = display_read;
-  io->write = display_write;
+  dsp->ops       = *io->ops;
+  dsp->ops.read  = display_read;
+  dsp->ops.write = display_write;
+  io->ops        = &dsp->ops;
 
   return 0;
 }
@@ -195,22 +201,180 @@ int32_t __IO_display_put_pixel(IO_io *io, uint16_t x, uint16_t y, uint32_t argb)
 
 WEAK_ALIAS(__IO_display_put_pixel, IO_display_put_pixel);
 
+//------------------------------------------------------------------------------
+// Get the color of a pixel
+//------------------------------------------------------------------------------
+int32_t __IO_display_get_pixel(IO_io *io, uint16_t x, uint16_t y,
+  uint32_t *argb)
+{
+  return -IO_ENOSYS;
+}
+
+WEAK_ALIAS(__IO_display_get_pixel, IO_display_get_pixel);
+
+//------------------------------------------------------------------------------
+// Get direct access to the framebuffer
+//------------------------------------------------------------------------------
+int32_t __IO_display_get_framebuffer(IO_io *io, IO_framebuffer *fb)
+{
+  return -IO_ENOSYS;
+}
+
+WEAK_ALIAS(__IO_display_get_framebuffer, IO_display_get_framebuffer);
+
+//------------------------------------------------------------------------------
+// Report a rectangle of the framebuffer as modified
+//------------------------------------------------------------------------------
+int32_t __IO_display_mark_dirty(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  return -IO_ENOSYS;
+}
+
+WEAK_ALIAS(__IO_display_mark_dirty, IO_display_mark_dirty);
+
 //------------------------------------------------------------------------------
 // Print bitmap
 //------------------------------------------------------------------------------
 int32_t __IO_display_print_bitmap(IO_io *io, uint16_t x, uint16_t y,
   const IO_bitmap *bitmap)
 {
-  const char *data = bitmap->data;
-  uint16_t w = bitmap->width;
-  for(int i = 0; i < w; ++i)
-    for(int j = 0; j < bitmap->height; ++j)
-      IO_display_put_pixel(io, x+i, y+j, ARR2D(data, i, j, w));
-  return 0;
+  return IO_display_blit_low(io, x, y, bitmap->width, bitmap->height,
+                             bitmap->data);
 }
 
 WEAK_ALIAS(__IO_display_print_bitmap, IO_display_print_bitmap);
 
+//------------------------------------------------------------------------------
+// Print bitmap through a mask
+//------------------------------------------------------------------------------
+int32_t __IO_display_blit_masked(IO_io *io, uint16_t x, uint16_t y,
+  const IO_bitmap *bitmap, const IO_bitmap *mask)
+{
+  if(!mask)
+    return IO_display_print_bitmap(io, x, y, bitmap);
+
+  const uint8_t *data = bitmap->data;
+  const uint8_t *msk  = mask->data;
+  uint8_t pages = (bitmap->height + 7) / 8;
+  for(int i = 0; i < bitmap->width; ++i)
+    for(int j = 0; j < bitmap->height; ++j) {
+      uint16_t byte = i*pages + j/8;
+      uint8_t  bit  = 1 << (j%8);
+      if(msk[byte] & bit)
+        IO_display_put_pixel(io, x+i, y+j, !(data[byte] & bit));
+    }
+  return 0;
+}
+
+WEAK_ALIAS(__IO_display_blit_masked, IO_display_blit_masked);
+
+//------------------------------------------------------------------------------
+// Fill a rectangle with ink
+//------------------------------------------------------------------------------
+int32_t __IO_display_fill_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  for(int i = 0; i < width; ++i)
+    for(int j = 0; j < height; ++j)
+      IO_display_put_pixel(io, x+i, y+j, 0);
+  return 0;
+}
+
+WEAK_ALIAS(__IO_display_fill_rect, IO_display_fill_rect);
+
+//------------------------------------------------------------------------------
+// Clear a rectangle to the background color
+//------------------------------------------------------------------------------
+int32_t __IO_display_clear_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  for(int i = 0; i < width; ++i)
+    for(int j = 0; j < height; ++j)
+      IO_display_put_pixel(io, x+i, y+j, 0xffffffff);
+  return 0;
+}
+
+WEAK_ALIAS(__IO_display_clear_rect, IO_display_clear_rect);
+
+//------------------------------------------------------------------------------
+// Invert all the pixels in a rectangle
+//------------------------------------------------------------------------------
+int32_t __IO_display_invert_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  for(int i = 0; i < width; ++i)
+    for(int j = 0; j < height; ++j) {
+      uint32_t argb;
+      if(IO_display_get_pixel(io, x+i, y+j, &argb))
+        continue;
+      IO_display_put_pixel(io, x+i, y+j, argb ? 0 : 0xffffffff);
+    }
+  return 0;
+}
+
+WEAK_ALIAS(__IO_display_invert_rect, IO_display_invert_rect);
+
+//------------------------------------------------------------------------------
+// Draw a horizontal line
+//------------------------------------------------------------------------------
+int32_t __IO_display_hline(IO_io *io, uint16_t x, uint16_t y, uint16_t length)
+{
+  return IO_display_fill_rect(io, x, y, length, 1);
+}
+
+WEAK_ALIAS(__IO_display_hline, IO_display_hline);
+
+//------------------------------------------------------------------------------
+// Draw a vertical line
+//------------------------------------------------------------------------------
+int32_t __IO_display_vline(IO_io *io, uint16_t x, uint16_t y, uint16_t length)
+{
+  return IO_display_fill_rect(io, x, y, 1, length);
+}
+
+WEAK_ALIAS(__IO_display_vline, IO_display_vline);
+
+//------------------------------------------------------------------------------
+// Copy a rectangle to another place on the screen
+//------------------------------------------------------------------------------
+int32_t __IO_display_copy_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, uint16_t to_x, uint16_t to_y)
+{
+  //----------------------------------------------------------------------------
+  // Walk away from the direction of the move so that we never read a pixel
+  // that has already been overwritten
+  //----------------------------------------------------------------------------
+  for(int i = 0; i < width; ++i) {
+    int ii = to_x > x ? width - 1 - i : i;
+    for(int j = 0; j < height; ++j) {
+      int jj = to_y > y ? height - 1 - j : j;
+      uint32_t argb;
+      if(IO_display_get_pixel(io, x+ii, y+jj, &argb))
+        continue;
+      IO_display_put_pixel(io, to_x+ii, to_y+jj, argb);
+    }
+  }
+  return 0;
+}
+
+WEAK_ALIAS(__IO_display_copy_rect, IO_display_copy_rect);
+
+//------------------------------------------------------------------------------
+// Blit packed columns
+//------------------------------------------------------------------------------
+int32_t __IO_display_blit_low(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, const uint8_t *data)
+{
+  uint8_t pages = (height + 7) / 8;
+  for(int i = 0; i < width; ++i, data += pages)
+    for(int j = 0; j < height; ++j)
+      IO_display_put_pixel(io, x+i, y+j, !(data[j/8] & (1 << (j%8))));
+  return 0;
+}
+
+WEAK_ALIAS(__IO_display_blit_low, IO_display_blit_low);
+
 //------------------------------------------------------------------------------
 // Get number of display devices available
 //------------------------------------------------------------------------------
@@ -231,7 +395,7 @@ int32_t IO_display_set_font(IO_io *io, const IO_font *font)
 
   displays[io->channel].font = font;
   displays[io->channel].line_height = font->size+1;
-  displays[io->channel].space_width = font->glyphs[0]->width;
+  displays[io->channel].space_width = font->advance[0];
   return 0;
 }
 
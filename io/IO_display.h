@@ -63,12 +63,119 @@ int32_t IO_display_clear(IO_io *io);
 //------------------------------------------------------------------------------
 int32_t IO_display_put_pixel(IO_io *io, uint16_t x, uint16_t y, uint32_t argb);
 
+//------------------------------------------------------------------------------
+//! Get the color of a pixel
+//!
+//! @param io   the IO device
+//! @param x    x coordinate
+//! @param y    y coordinate
+//! @param argb output for the color of the pixel in ARGB mode
+//------------------------------------------------------------------------------
+int32_t IO_display_get_pixel(IO_io *io, uint16_t x, uint16_t y, uint32_t *argb);
+
+//------------------------------------------------------------------------------
+//! Framebuffer of a monochrome display
+//!
+//! The pixels are organized in pages of stride bytes; each byte holds a
+//! column of 8 rows with the top-most row in the least significant bit and
+//! a set bit marks the ink.
+//------------------------------------------------------------------------------
+struct IO_framebuffer {
+  uint8_t  *pixels;  //!< the first page
+  uint16_t  stride;  //!< number of bytes in a page
+  uint16_t  width;   //!< width in pixels
+  uint16_t  height;  //!< height in pixels
+};
+
+typedef struct IO_framebuffer IO_framebuffer;
+
+//------------------------------------------------------------------------------
+//! Get direct access to the framebuffer
+//!
+//! Whoever modifies the pixels directly needs to report the modified area with
+//! IO_display_mark_dirty, otherwise it may never reach the screen.
+//!
+//! @return -IO_ENOSYS if the display has no framebuffer of this format
+//------------------------------------------------------------------------------
+int32_t IO_display_get_framebuffer(IO_io *io, IO_framebuffer *fb);
+
+//------------------------------------------------------------------------------
+//! Report a rectangle of the framebuffer as modified
+//------------------------------------------------------------------------------
+int32_t IO_display_mark_dirty(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
 //------------------------------------------------------------------------------
 //! Print bitmap
 //------------------------------------------------------------------------------
 int32_t IO_display_print_bitmap(IO_io *io, uint16_t x, uint16_t y,
   const IO_bitmap *bitmap);
 
+//------------------------------------------------------------------------------
+//! Print bitmap through a mask
+//!
+//! @param io     the IO device
+//! @param x      x coordinate of the top-left corner
+//! @param y      y coordinate of the top-left corner
+//! @param bitmap the bitmap to print
+//! @param mask   only the pixels set in the mask are printed; may be the
+//!               bitmap itself to draw only the ink, if null the whole box is
+//!               overwritten
+//------------------------------------------------------------------------------
+int32_t IO_display_blit_masked(IO_io *io, uint16_t x, uint16_t y,
+  const IO_bitmap *bitmap, const IO_bitmap *mask);
+
+//------------------------------------------------------------------------------
+//! Fill a rectangle with ink
+//!
+//! @param io     the IO device
+//! @param x      x coordinate of the top-left corner
+//! @param y      y coordinate of the top-left corner
+//! @param width  width of the rectangle
+//! @param height height of the rectangle
+//------------------------------------------------------------------------------
+int32_t IO_display_fill_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Clear a rectangle to the background color
+//------------------------------------------------------------------------------
+int32_t IO_display_clear_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Invert all the pixels in a rectangle
+//------------------------------------------------------------------------------
+int32_t IO_display_invert_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height);
+
+//------------------------------------------------------------------------------
+//! Draw a horizontal line
+//------------------------------------------------------------------------------
+int32_t IO_display_hline(IO_io *io, uint16_t x, uint16_t y, uint16_t length);
+
+//------------------------------------------------------------------------------
+//! Draw a vertical line
+//------------------------------------------------------------------------------
+int32_t IO_display_vline(IO_io *io, uint16_t x, uint16_t y, uint16_t length);
+
+//------------------------------------------------------------------------------
+//! Copy a rectangle to another place on the screen
+//!
+//! The source and the destination may overlap, so it may be used to scroll
+//! parts of the screen. The area uncovered by the move is left intact.
+//!
+//! @param io     the IO device
+//! @param x      x coordinate of the top-left corner of the source
+//! @param y      y coordinate of the top-left corner of the source
+//! @param width  width of the rectangle
+//! @param height height of the rectangle
+//! @param to_x   x coordinate of the top-left corner of the destination
+//! @param to_y   y coordinate of the top-left corner of the destination
+//------------------------------------------------------------------------------
+int32_t IO_display_copy_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, uint16_t to_x, uint16_t to_y);
+
 //------------------------------------------------------------------------------
 //! Set font for the display
 //------------------------------------------------------------------------------
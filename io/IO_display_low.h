@@ -47,3 +47,18 @@ int32_t IO_display_count_low();
 //! Clear the display
 //------------------------------------------------------------------------------
 int32_t IO_display_clear_low(IO_io *io);
+
+//------------------------------------------------------------------------------
+//! Blit a box of packed columns
+//!
+//! @param io     the IO device
+//! @param x      x coordinate of the top-left corner
+//! @param y      y coordinate of the top-left corner
+//! @param width  number of columns
+//! @param height number of rows
+//! @param data   (height+7)/8 bytes per column, top row in the least
+//!               significant bit, set bits are black; the whole box is
+//!               overwritten
+//------------------------------------------------------------------------------
+int32_t IO_display_blit_low(IO_io *io, uint16_t x, uint16_t y, uint16_t width,
+  uint16_t height, const uint8_t *data);
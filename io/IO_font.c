@@ -47,16 +47,43 @@ const IO_font *IO_font_get_by_name(const char *name)
 }
 
 //------------------------------------------------------------------------------
-// Get glyph for the given character
+// Glyph indices of the ASCII characters; the unprintable ones and the ones we
+// have no glyphs for are represented by '#'
 //------------------------------------------------------------------------------
-const IO_bitmap *IO_font_get_glyph(const IO_font *font, char ch)
+static const uint8_t glyph_index[128] = {
+   3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+   3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+  16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+  32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+  48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62,  3,
+   3, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77,
+  78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92,  3
+};
+
+//------------------------------------------------------------------------------
+// Get index of the glyph for the given character
+//------------------------------------------------------------------------------
+uint8_t IO_font_get_glyph(char ch)
+{
+  uint8_t c = ch;
+  if(c > 127)
+    return 3;
+  return glyph_index[c];
+}
+
+//------------------------------------------------------------------------------
+// Get width of the given text
+//------------------------------------------------------------------------------
+uint16_t IO_font_get_width(const IO_font *font, const char *text)
 {
-  if(!font) return 0;
-  if(ch < 32) return font->glyphs[3];
-  if(ch < 95) return font->glyphs[ch-32];
-  if(ch == 95 || ch == 96) return font->glyphs[3];
-  if(ch < 127) return font->glyphs[ch-34];
-  return font->glyphs[3];
+  uint16_t width = 0;
+  for(; *text; ++text) {
+    if(*text == '\r' || *text == '\n')
+      continue;
+    width += font->advance[IO_font_get_glyph(*text)];
+  }
+  return width;
 }
 
 //------------------------------------------------------------------------------
@@ -65,14 +92,33 @@ const IO_bitmap *IO_font_get_glyph(const IO_font *font, char ch)
 void IO_font_get_box(const IO_font *font, const char *text, uint16_t *width,
   uint16_t *height)
 {
-  *width = 0;
+  *width  = IO_font_get_width(font, text);
   *height = font->size;
-  while(*text) {
-    if(*text == '\r' || *text == '\n') {
-      ++text;
+}
+
+//------------------------------------------------------------------------------
+// Render the text into an off-screen bitmap; the glyph columns have exactly
+// the layout of the bitmap columns, so we only need to copy them
+//------------------------------------------------------------------------------
+uint16_t IO_font_render(const IO_font *font, const char *text,
+  IO_bitmap *bitmap, uint16_t size)
+{
+  uint8_t  *data  = bitmap->data;
+  uint16_t  width = 0;
+  for(; *text; ++text) {
+    if(*text == '\r' || *text == '\n')
       continue;
-    }
-    *width += IO_font_get_glyph(font, *text)->width;
-    ++text;
+    uint8_t glyph   = IO_font_get_glyph(*text);
+    uint16_t length = font->advance[glyph] * font->pages;
+    if(length > size)
+      break;
+    memcpy(data, font->strip + font->offset[glyph], length);
+    data  += length;
+    size  -= length;
+    width += font->advance[glyph];
   }
+  bitmap->width  = width;
+  bitmap->height = font->size;
+  bitmap->bpp    = 1;
+  return width;
 }
@@ -21,16 +21,22 @@
 
 #include "IO.h"
 
-struct IO_bitmap;
-typedef struct IO_bitmap IO_bitmap;
-
 //------------------------------------------------------------------------------
 //! Font description
+//!
+//! The glyphs are stored as a strip of packed columns. Each column consists of
+//! pages bytes; each byte holds 8 rows with the top-most row in the least
+//! significant bit and a set bit marks the ink. All the glyphs have the same
+//! height and are as wide as their advance.
 //------------------------------------------------------------------------------
 struct IO_font {
-  const char *name;
-  uint8_t     size;
-  IO_bitmap  *glyphs[93];
+  const char     *name;     //!< name of the font
+  uint8_t         size;     //!< height of the glyphs
+  uint8_t         baseline; //!< distance from the top of a glyph to the baseline
+  uint8_t         pages;    //!< number of bytes per column
+  const uint8_t  *advance;  //!< advance widths of the glyphs
+  const uint16_t *offset;   //!< offsets of the glyphs in the strip
+  const uint8_t  *strip;    //!< glyph columns
 };
 
 typedef struct IO_font IO_font;
@@ -41,12 +47,28 @@ typedef struct IO_font IO_font;
 const IO_font *IO_font_get_by_name(const char *name);
 
 //------------------------------------------------------------------------------
-//! Get glyph for the given character
+//! Get index of the glyph representing given character
+//------------------------------------------------------------------------------
+uint8_t IO_font_get_glyph(char ch);
+
+//------------------------------------------------------------------------------
+//! Get width of the given text
 //------------------------------------------------------------------------------
-const IO_bitmap *IO_font_get_glyph(const IO_font *font, char ch);
+uint16_t IO_font_get_width(const IO_font *font, const char *text);
 
 //------------------------------------------------------------------------------
 //! Get dimensions of the box containing given text
 //------------------------------------------------------------------------------
 void IO_font_get_box(const IO_font *font, const char *text, uint16_t *width,
   uint16_t *height);
+
+//------------------------------------------------------------------------------
+//! Render the text into an off-screen bitmap
+//!
+//! The bitmap is set up to hold packed columns of the font's height; as many
+//! glyphs as fit in size bytes of its data are rendered.
+//!
+//! @return width of the rendered text
+//------------------------------------------------------------------------------
+uint16_t IO_font_render(const IO_font *font, const char *text,
+  IO_bitmap *bitmap, uint16_t size);
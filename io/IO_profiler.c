@@ -19,6 +19,8 @@
 
 #include "IO_profiler.h"
 #include "IO_error.h"
+#include "IO_utils.h"
+#include <string.h>
 
 //------------------------------------------------------------------------------
 // Profiler state
@@ -57,3 +59,83 @@ int32_t IO_profiler_toggle(uint8_t num)
   }
   return 0;
 }
+
+//------------------------------------------------------------------------------
+// Get the value of the cycle counter
+//------------------------------------------------------------------------------
+uint32_t __IO_profiler_cycles()
+{
+  return 0;
+}
+
+WEAK_ALIAS(__IO_profiler_cycles, IO_profiler_cycles);
+
+//------------------------------------------------------------------------------
+// Get the number of cycles per second
+//------------------------------------------------------------------------------
+uint32_t __IO_profiler_frequency()
+{
+  return 0;
+}
+
+WEAK_ALIAS(__IO_profiler_frequency, IO_profiler_frequency);
+
+//------------------------------------------------------------------------------
+// Start a new window
+//------------------------------------------------------------------------------
+static void histogram_reset(IO_histogram *hist)
+{
+  memset(hist->buckets, 0, sizeof(hist->buckets));
+  hist->count = 0;
+  hist->sum   = 0;
+  hist->min   = 0xffffffff;
+  hist->max   = 0;
+}
+
+//------------------------------------------------------------------------------
+// Initialize a histogram
+//------------------------------------------------------------------------------
+void IO_histogram_init(IO_histogram *hist, uint16_t window)
+{
+  memset(&hist->stats, 0, sizeof(hist->stats));
+  hist->window = window;
+  histogram_reset(hist);
+}
+
+//------------------------------------------------------------------------------
+// Add a sample to the histogram
+//------------------------------------------------------------------------------
+void IO_histogram_add(IO_histogram *hist, uint32_t value)
+{
+  uint8_t bucket = value ? 32 - __builtin_clz(value) : 0;
+  ++hist->buckets[bucket];
+  ++hist->count;
+  hist->sum += value;
+  if(value < hist->min)
+    hist->min = value;
+  if(value > hist->max)
+    hist->max = value;
+
+  if(hist->count < hist->window)
+    return;
+
+  //----------------------------------------------------------------------------
+  // The window is complete; the 99th percentile falls into the first bucket
+  // from the top at which more than 1% of the samples have been seen
+  //----------------------------------------------------------------------------
+  uint16_t tail = hist->count / 100;
+  uint16_t seen = 0;
+  int i;
+  for(i = IO_HISTOGRAM_BUCKETS - 1; i > 0; --i) {
+    seen += hist->buckets[i];
+    if(seen > tail)
+      break;
+  }
+  uint32_t upper = i == 32 ? 0xffffffff : (1UL << i) - 1;
+
+  hist->stats.min = hist->min;
+  hist->stats.avg = hist->sum / hist->count;
+  hist->stats.p99 = upper < hist->max ? upper : hist->max;
+  hist->stats.max = hist->max;
+  histogram_reset(hist);
+}
@@ -35,3 +35,59 @@ int32_t IO_profiler_channel_add(uint8_t num, IO_io *gpio);
 //! @param num number of the channel to toggle
 //------------------------------------------------------------------------------
 int32_t IO_profiler_toggle(uint8_t num);
+
+//------------------------------------------------------------------------------
+//! Get the value of the free-running cycle counter
+//!
+//! The counter wraps around, so only differences of nearby readings are
+//! meaningful; it always reads zero if the platform has no such counter.
+//------------------------------------------------------------------------------
+uint32_t IO_profiler_cycles();
+
+//------------------------------------------------------------------------------
+//! Get the number of cycles per second
+//------------------------------------------------------------------------------
+uint32_t IO_profiler_frequency();
+
+//------------------------------------------------------------------------------
+//! Statistics of a histogram window
+//------------------------------------------------------------------------------
+struct IO_histogram_stats {
+  uint32_t min;
+  uint32_t avg;
+  uint32_t p99;  //!< upper bound of the 99th percentile, within a factor of 2
+  uint32_t max;
+};
+
+typedef struct IO_histogram_stats IO_histogram_stats;
+
+//------------------------------------------------------------------------------
+//! Rolling histogram
+//!
+//! The samples are counted in power-of-two buckets. Every time a window of
+//! samples is complete, its statistics are published and the histogram
+//! starts over.
+//------------------------------------------------------------------------------
+#define IO_HISTOGRAM_BUCKETS 33
+
+struct IO_histogram {
+  uint16_t           window;   //!< number of samples in a window
+  uint16_t           count;    //!< samples collected in the current window
+  uint32_t           min;
+  uint32_t           max;
+  uint64_t           sum;
+  uint16_t           buckets[IO_HISTOGRAM_BUCKETS]; //!< by the bit length
+  IO_histogram_stats stats;    //!< the last complete window
+};
+
+typedef struct IO_histogram IO_histogram;
+
+//------------------------------------------------------------------------------
+//! Initialize a histogram
+//------------------------------------------------------------------------------
+void IO_histogram_init(IO_histogram *hist, uint16_t window);
+
+//------------------------------------------------------------------------------
+//! Add a sample to the histogram
+//------------------------------------------------------------------------------
+void IO_histogram_add(IO_histogram *hist, uint32_t value);
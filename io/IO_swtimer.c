@@ -0,0 +1,202 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#define __IO_IMPL__
+#include "IO.h"
+#include "IO_sys.h"
+#include "IO_swtimer.h"
+#include "IO_swtimer_low.h"
+#include "IO_utils.h"
+#include "IO_error.h"
+
+//------------------------------------------------------------------------------
+// Program the hardware timer
+//------------------------------------------------------------------------------
+void __IO_swtimer_arm(uint64_t deadline) {}
+WEAK_ALIAS(__IO_swtimer_arm, IO_swtimer_arm);
+
+//------------------------------------------------------------------------------
+// The running timers in a binary min-heap ordered by the deadline
+//------------------------------------------------------------------------------
+static IO_swtimer *heap[IO_SWTIMER_MAX];
+static uint16_t    heap_size = 0;
+
+//------------------------------------------------------------------------------
+// Put the timer in the slot
+//------------------------------------------------------------------------------
+static void heap_place(IO_swtimer *timer, uint16_t slot)
+{
+  heap[slot] = timer;
+  timer->slot = slot;
+}
+
+//------------------------------------------------------------------------------
+// Move the timer towards the root until the parent expires earlier
+//------------------------------------------------------------------------------
+static void heap_up(IO_swtimer *timer, uint16_t slot)
+{
+  while(slot) {
+    uint16_t parent = (slot - 1) / 2;
+    if(heap[parent]->deadline <= timer->deadline)
+      break;
+    heap_place(heap[parent], slot);
+    slot = parent;
+  }
+  heap_place(timer, slot);
+}
+
+//------------------------------------------------------------------------------
+// Move the timer towards the leaves until both children expire later
+//------------------------------------------------------------------------------
+static void heap_down(IO_swtimer *timer, uint16_t slot)
+{
+  while(1) {
+    uint16_t child = 2 * slot + 1;
+    if(child >= heap_size)
+      break;
+    if(child + 1 < heap_size &&
+       heap[child + 1]->deadline < heap[child]->deadline)
+      ++child;
+    if(timer->deadline <= heap[child]->deadline)
+      break;
+    heap_place(heap[child], slot);
+    slot = child;
+  }
+  heap_place(timer, slot);
+}
+
+//------------------------------------------------------------------------------
+// Take the timer out of the heap
+//------------------------------------------------------------------------------
+static void heap_remove(IO_swtimer *timer)
+{
+  uint16_t slot = timer->slot;
+  timer->slot = -1;
+  IO_swtimer *last = heap[--heap_size];
+  if(last == timer)
+    return;
+
+  if(slot && heap[(slot - 1) / 2]->deadline > last->deadline)
+    heap_up(last, slot);
+  else
+    heap_down(last, slot);
+}
+
+//------------------------------------------------------------------------------
+// Tell the hardware about the nearest deadline
+//------------------------------------------------------------------------------
+static void heap_arm()
+{
+  IO_swtimer_arm(heap_size ? heap[0]->deadline : 0);
+}
+
+//------------------------------------------------------------------------------
+// Initialize a software timer
+//------------------------------------------------------------------------------
+void IO_swtimer_init(IO_swtimer *timer, void (*callback)(IO_swtimer *),
+  void *data)
+{
+  timer->deadline = 0;
+  timer->period   = 0;
+  timer->callback = callback;
+  timer->data     = data;
+  timer->slot     = -1;
+}
+
+//------------------------------------------------------------------------------
+// Start a software timer
+//------------------------------------------------------------------------------
+int32_t IO_swtimer_start(IO_swtimer *timer, uint64_t timeout, uint64_t period)
+{
+  IO_disable_interrupts();
+  if(timer->slot >= 0)
+    heap_remove(timer);
+
+  if(heap_size == IO_SWTIMER_MAX) {
+    IO_enable_interrupts();
+    return -IO_EBUSY;
+  }
+
+  timer->deadline = IO_time_ns() + timeout;
+  timer->period   = period;
+  heap_up(timer, heap_size++);
+
+  if(heap[0] == timer)
+    heap_arm();
+  IO_enable_interrupts();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Stop a software timer; the hardware is left armed for the old deadline if
+// the timer was the nearest one, the interrupt just finds nothing to do
+//------------------------------------------------------------------------------
+void IO_swtimer_stop(IO_swtimer *timer)
+{
+  IO_disable_interrupts();
+  if(timer->slot >= 0)
+    heap_remove(timer);
+  IO_enable_interrupts();
+}
+
+//------------------------------------------------------------------------------
+// Check whether the timer is running
+//------------------------------------------------------------------------------
+int IO_swtimer_active(const IO_swtimer *timer)
+{
+  return timer->slot >= 0;
+}
+
+//------------------------------------------------------------------------------
+// Get the number of the timers running
+//------------------------------------------------------------------------------
+uint16_t IO_swtimer_count()
+{
+  return heap_size;
+}
+
+//------------------------------------------------------------------------------
+// Run the expired timers; the periodic ones are put back before their
+// callbacks run, so that the callbacks may stop or restart them
+//------------------------------------------------------------------------------
+void IO_swtimer_expire()
+{
+  IO_disable_interrupts();
+  uint64_t now = IO_time_ns();
+  while(heap_size && heap[0]->deadline <= now) {
+    IO_swtimer *timer = heap[0];
+    heap_remove(timer);
+
+    if(timer->period) {
+      timer->deadline += timer->period;
+      if(timer->deadline <= now) {
+        uint64_t missed = (now - timer->deadline) / timer->period + 1;
+        timer->deadline += missed * timer->period;
+      }
+      heap_up(timer, heap_size++);
+    }
+
+    IO_enable_interrupts();
+    timer->callback(timer);
+    IO_disable_interrupts();
+    now = IO_time_ns();
+  }
+  heap_arm();
+  IO_enable_interrupts();
+}
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+//! Maximum number of software timers running at the same time
+//------------------------------------------------------------------------------
+#define IO_SWTIMER_MAX 256
+
+//------------------------------------------------------------------------------
+//! Software timer
+//!
+//! All the software timers are multiplexed on one hardware timer that is
+//! programmed for the nearest deadline. The callbacks run in the interrupt
+//! context, so they should be short.
+//------------------------------------------------------------------------------
+struct IO_swtimer {
+  uint64_t deadline;                          //!< expiry time in nanoseconds
+  uint64_t period;                            //!< 0 for one-shot timers
+  void   (*callback)(struct IO_swtimer *timer);
+  void    *data;                              //!< user data
+  int16_t  slot;                              //!< -1 if the timer is idle
+};
+
+typedef struct IO_swtimer IO_swtimer;
+
+//------------------------------------------------------------------------------
+//! Initialize a software timer
+//!
+//! @param timer    the timer
+//! @param callback function to be called when the timer expires
+//! @param data     user data
+//------------------------------------------------------------------------------
+void IO_swtimer_init(IO_swtimer *timer, void (*callback)(IO_swtimer *),
+  void *data);
+
+//------------------------------------------------------------------------------
+//! Start a software timer; restarts it if it is already running
+//!
+//! A periodic timer expires at multiples of the period from the first
+//! deadline, so the latency of the callbacks does not accumulate; the
+//! deadlines missed altogether are skipped.
+//!
+//! @param timer   the timer
+//! @param timeout time to the first expiry in nanoseconds
+//! @param period  period in nanoseconds, 0 for a one-shot timer
+//! @return        -IO_EBUSY if there are IO_SWTIMER_MAX timers running already
+//------------------------------------------------------------------------------
+int32_t IO_swtimer_start(IO_swtimer *timer, uint64_t timeout, uint64_t period);
+
+//------------------------------------------------------------------------------
+//! Stop a software timer; does nothing if the timer is idle
+//------------------------------------------------------------------------------
+void IO_swtimer_stop(IO_swtimer *timer);
+
+//------------------------------------------------------------------------------
+//! Check whether the timer is running
+//------------------------------------------------------------------------------
+int IO_swtimer_active(const IO_swtimer *timer);
+
+//------------------------------------------------------------------------------
+//! Get the number of the timers running
+//------------------------------------------------------------------------------
+uint16_t IO_swtimer_count();
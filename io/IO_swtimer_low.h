@@ -19,22 +19,24 @@
 
 #pragma once
 
-#include <io/IO.h>
+#ifndef __IO_IMPL__
+#error "This is a low-level header for driver implementation purposes only"
+#endif
 
-//------------------------------------------------------------------------------
-// Enable/disable UART events
-//------------------------------------------------------------------------------
-int32_t TM4C_uart_event_enable(IO_io *io, uint16_t events);
-int32_t TM4C_uart_event_disable(IO_io *io, uint16_t events);
+#include "IO_swtimer.h"
+#include <stdint.h>
 
 //------------------------------------------------------------------------------
-// Enable/disable SSI events
+//! Program the hardware timer to interrupt at the given time
+//!
+//! @param deadline time in nanoseconds, as returned by IO_time_ns; the
+//!                 interrupt should come as soon as possible if it is in the
+//!                 past; 0 means that no timers are running
 //------------------------------------------------------------------------------
-int32_t TM4C_ssi_event_enable(IO_io *io, uint16_t events);
-int32_t TM4C_ssi_event_disable(IO_io *io, uint16_t events);
+void IO_swtimer_arm(uint64_t deadline);
 
 //------------------------------------------------------------------------------
-// Enable/disable ADC events
+//! Run the callbacks of the expired timers and re-arm the hardware; to be
+//! called by the interrupt handler of the hardware timer
 //------------------------------------------------------------------------------
-int32_t TM4C_adc_event_enable(IO_io *io, uint16_t events);
-int32_t TM4C_adc_event_disable(IO_io *io, uint16_t events);
+void IO_swtimer_expire();
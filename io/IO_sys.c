@@ -36,6 +36,18 @@ WEAK_ALIAS(__IO_enable_interrupts, IO_enable_interrupts);
 void __IO_disable_interrupts() {}
 WEAK_ALIAS(__IO_disable_interrupts, IO_disable_interrupts);
 
+//------------------------------------------------------------------------------
+// Save and disable interrupts
+//------------------------------------------------------------------------------
+uint32_t __IO_save_interrupts() { return 0; }
+WEAK_ALIAS(__IO_save_interrupts, IO_save_interrupts);
+
+//------------------------------------------------------------------------------
+// Restore interrupts
+//------------------------------------------------------------------------------
+void __IO_restore_interrupts(uint32_t state) {}
+WEAK_ALIAS(__IO_restore_interrupts, IO_restore_interrupts);
+
 //------------------------------------------------------------------------------
 // Wait for an interrupt
 //------------------------------------------------------------------------------
@@ -67,6 +79,12 @@ WEAK_ALIAS(__IO_sys_stack_init, IO_sys_stack_init);
 void __IO_sys_yield() {}
 WEAK_ALIAS(__IO_sys_yield, IO_sys_yield);
 
+//------------------------------------------------------------------------------
+// Check whether we run in an interrupt handler
+//------------------------------------------------------------------------------
+int __IO_sys_in_interrupt() { return 0; }
+WEAK_ALIAS(__IO_sys_in_interrupt, IO_sys_in_interrupt);
+
 //------------------------------------------------------------------------------
 // Thread book keeping
 //------------------------------------------------------------------------------
@@ -239,31 +257,78 @@ void IO_sys_semaphore_init(IO_sys_semaphore *sem, int32_t val)
 }
 
 //------------------------------------------------------------------------------
-// Signal
+// Signal; may be called with the interrupts disabled, they stay disabled
 //------------------------------------------------------------------------------
 void IO_sys_signal(IO_sys_semaphore *sem)
 {
-  IO_disable_interrupts();
+  uint32_t state = IO_save_interrupts();
   ++*sem;
   if(*sem <= 0 && threads) {
     IO_sys_thread *t;
     for(t = threads; t->blocker != sem; t = t->next);
     t->blocker = 0;
   }
-  IO_enable_interrupts();
+  IO_restore_interrupts(state);
 }
 
 //------------------------------------------------------------------------------
-// Wait
+// Wait; blocking needs the interrupts enabled on entry, the context switch
+// would be held off otherwise
 //------------------------------------------------------------------------------
 void IO_sys_wait(IO_sys_semaphore *sem)
 {
-  IO_disable_interrupts();
+  uint32_t state = IO_save_interrupts();
   --*sem;
   if(*sem < 0) {
     IO_sys_current->blocker = sem;
-    IO_enable_interrupts();
+    IO_restore_interrupts(state);
     IO_sys_yield();
   }
+  IO_restore_interrupts(state);
+}
+
+//------------------------------------------------------------------------------
+// Check whether the caller may sleep
+//------------------------------------------------------------------------------
+int IO_sys_can_block()
+{
+  return IO_sys_current && !IO_sys_in_interrupt();
+}
+
+//------------------------------------------------------------------------------
+// Initialize the completion
+//------------------------------------------------------------------------------
+void IO_sys_completion_init(IO_sys_completion *comp)
+{
+  IO_sys_semaphore_init(&comp->sem, 0);
+  comp->waiting = 0;
+}
+
+//------------------------------------------------------------------------------
+// Sleep on the completion; the sleeper is counted with the interrupts
+// disabled, so the handler either sees it and signals or has run before the
+// check; a signal that comes before the wait just makes the wait return
+//------------------------------------------------------------------------------
+void IO_sys_completion_wait(IO_sys_completion *comp)
+{
+  ++comp->waiting;
   IO_enable_interrupts();
+  IO_sys_wait(&comp->sem);
+}
+
+//------------------------------------------------------------------------------
+// Wake up the sleepers; the semaphore wakes one thread per signal. The
+// scheduler only runs at the end of the time slice, so we ask for it right
+// away, or the woken threads would sit idle for up to a slice.
+//------------------------------------------------------------------------------
+void IO_sys_complete(IO_sys_completion *comp)
+{
+  uint32_t state = IO_save_interrupts();
+  uint8_t woken = comp->waiting;
+  for(; comp->waiting; --comp->waiting)
+    IO_sys_signal(&comp->sem);
+  IO_restore_interrupts(state);
+
+  if(woken)
+    IO_sys_yield();
 }
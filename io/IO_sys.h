@@ -31,6 +31,17 @@ void IO_enable_interrupts();
 //------------------------------------------------------------------------------
 void IO_disable_interrupts();
 
+//------------------------------------------------------------------------------
+//! Disable interrupts and return the previous state for
+//! IO_restore_interrupts; unlike IO_disable_interrupts, the pair nests
+//------------------------------------------------------------------------------
+uint32_t IO_save_interrupts();
+
+//------------------------------------------------------------------------------
+//! Restore the interrupt state saved by IO_save_interrupts
+//------------------------------------------------------------------------------
+void IO_restore_interrupts(uint32_t state);
+
 //------------------------------------------------------------------------------
 //! Wait for an interrupt
 //------------------------------------------------------------------------------
@@ -107,3 +118,41 @@ void IO_sys_signal(IO_sys_semaphore *sem);
 //! @param sem semaphore
 //------------------------------------------------------------------------------
 void IO_sys_wait(IO_sys_semaphore *sem);
+
+//------------------------------------------------------------------------------
+//! Check whether the caller may put itself to sleep, ie. the operating system
+//! is running and we are not in an interrupt handler; the drivers busy-wait
+//! otherwise
+//------------------------------------------------------------------------------
+int IO_sys_can_block();
+
+//------------------------------------------------------------------------------
+//! Completion - lets threads sleep until an interrupt handler reports that
+//! the hardware is done
+//------------------------------------------------------------------------------
+struct IO_sys_completion {
+  IO_sys_semaphore sem;
+  volatile uint8_t waiting;  //!< number of the sleeping threads
+};
+
+typedef struct IO_sys_completion IO_sys_completion;
+
+//------------------------------------------------------------------------------
+//! Initialize the completion
+//------------------------------------------------------------------------------
+void IO_sys_completion_init(IO_sys_completion *comp);
+
+//------------------------------------------------------------------------------
+//! Sleep on the completion
+//!
+//! Needs to be called with the interrupts disabled after checking that the
+//! hardware is not done yet; returns with the interrupts enabled.
+//------------------------------------------------------------------------------
+void IO_sys_completion_wait(IO_sys_completion *comp);
+
+//------------------------------------------------------------------------------
+//! Wake up all the threads sleeping on the completion, if any, and let the
+//! scheduler run them as soon as the handler returns; to be called from
+//! interrupt handlers or with the interrupts disabled
+//------------------------------------------------------------------------------
+void IO_sys_complete(IO_sys_completion *comp);
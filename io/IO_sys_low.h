@@ -57,6 +57,11 @@ void IO_sys_schedule();
 void IO_sys_stack_init(IO_sys_thread *thread, void (*func)(void *), void *arg,
   void *stack, uint32_t stack_size);
 
+//------------------------------------------------------------------------------
+//! Check whether we run in an interrupt handler
+//------------------------------------------------------------------------------
+int IO_sys_in_interrupt();
+
 //------------------------------------------------------------------------------
 //! Timer tick to be called every milisecond
 //!
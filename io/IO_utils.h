@@ -20,6 +20,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 //------------------------------------------------------------------------------
 // Make a weak alias of the given function
@@ -36,3 +37,18 @@
 //------------------------------------------------------------------------------
 #define CONTAINER_OF(TYPE, MEMBER, MEMBER_ADDR) \
   ((TYPE *) ( (char *)MEMBER_ADDR - offsetof(TYPE, MEMBER)))
+
+//------------------------------------------------------------------------------
+// High 64 bits of a 64x64 bit product, computed with 32x32 bit multiplies
+//------------------------------------------------------------------------------
+static inline uint64_t mulhi64(uint64_t a, uint64_t b)
+{
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t p0 = a_lo * b_lo;
+  uint64_t p1 = a_lo * b_hi;
+  uint64_t p2 = a_hi * b_lo;
+  uint64_t p3 = a_hi * b_hi;
+  uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+  return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
@@ -45,7 +45,8 @@ def getImage(font, letter, prefix):
   #-----------------------------------------------------------------------------
   # Crop the image
   #-----------------------------------------------------------------------------
-  img = img.crop(img.getbbox())
+  bbox = img.getbbox()
+  img = img.crop(bbox)
   width, height = img.size
   px = img.load()
 
@@ -63,22 +64,27 @@ def getImage(font, letter, prefix):
       break
 
   img = img.crop((newi, 0, width, height))
-  return img
+  return (img, bbox[1])
 
 #-------------------------------------------------------------------------------
-# Get pixel data
+# Get pixel data packed in columns; every column is a sequence of bytes each
+# holding 8 rows with the top-most row in the least significant bit; a set bit
+# marks the ink
 #-------------------------------------------------------------------------------
 def getPixelData(img):
   px = img.load()
   width, height = img.size
-  pixels = []
-  for j in range(height):
-    for i in range(width):
-      if px[i, j] == (0, 0, 0):
-        pixels.append(1)
-      else:
-        pixels.append(0)
-  return (width, height, 1, pixels)
+  pages = (height + 7) // 8
+  columns = []
+  for i in range(width):
+    for p in range(pages):
+      byte = 0
+      for b in range(8):
+        j = p * 8 + b
+        if j < height and px[i, j] != (0, 0, 0):
+          byte |= (1 << b)
+      columns.append(byte)
+  return (width, height, pages, columns)
 
 #-------------------------------------------------------------------------------
 # Generate all the glyphs
@@ -99,57 +105,71 @@ def generateGlyphs(font):
   # Iterate over all printable characters
   #-----------------------------------------------------------------------------
   glyphs = []
-  for i in range(33, 95):
-    image = getImage(font, chr(i), prefix)
-    glyphs.append(getPixelData(image))
-
-  for i in range(97, 127):
-    image = getImage(font, chr(i), prefix)
+  top = 0
+  for i in range(33, 95) + range(97, 127):
+    image, top = getImage(font, chr(i), prefix)
     glyphs.append(getPixelData(image))
 
   #-----------------------------------------------------------------------------
   # Make space to be as wide as letter 'l'
   #-----------------------------------------------------------------------------
   l = glyphs[73]
-  space = (l[0], l[1], l[2], [1] * (l[0]*l[1]))
+  space = (l[0], l[1], l[2], [0] * (l[0]*l[2]))
   glyphs = [space] + glyphs
-  return glyphs
+
+  #-----------------------------------------------------------------------------
+  # The text is drawn at the origin, so the baseline is at the ascent; all the
+  # glyphs are cropped to the same bounding box of the whole prefix
+  #-----------------------------------------------------------------------------
+  baseline = font.getmetrics()[0] - top
+  return (glyphs, max(0, baseline))
 
 #-------------------------------------------------------------------------------
 # Write header
 #-------------------------------------------------------------------------------
 def writeHeader(f):
   f.write("// This file has been generated autmatically, do not edit!\n\n")
-  f.write("#include <io/IO_font.h>\n")
-  f.write("#include <io/IO_display.h>\n\n")
+  f.write("#include <io/IO_font.h>\n\n")
 
 #-------------------------------------------------------------------------------
-# Write glyphs
+# Write the glyph strip; all the glyph columns are concatenated
 #-------------------------------------------------------------------------------
 def writeGlyphs(f, name, glyphs):
+  f.write("static const uint8_t " + name + "_strip[] = {\n")
   for i in range(len(glyphs)):
-    glyph = glyphs[i]
-    f.write("static const char " + name + "_glyph_" + str(i) + "_data[] = ");
-    f.write("{" + str(glyph[3])[1:-1] + "};\n");
-    f.write("static const IO_bitmap " + name + "_glyph_" + str(i) + " = {");
-    f.write(str(glyph[0]) + ", " + str(glyph[1]) + ", " + str(glyph[2]) + ", ")
-    f.write("(void*)" + name + "_glyph_" + str(i) + "_data};\n")
+    data = ["0x%02x" % b for b in glyphs[i][3]]
+    f.write("  " + ", ".join(data) + ", // " + str(i) + "\n")
+  f.write("};\n\n")
 
-  f.write("\n")
+#-------------------------------------------------------------------------------
+# Write the offset and advance tables
+#-------------------------------------------------------------------------------
+def writeTables(f, name, glyphs):
+  offsets = []
+  offset = 0
+  for g in glyphs:
+    offsets.append(str(offset))
+    offset += len(g[3])
+
+  f.write("static const uint16_t " + name + "_offset[] = {\n  ")
+  f.write(", ".join(offsets) + "};\n\n")
+  f.write("static const uint8_t " + name + "_advance[] = {\n  ")
+  f.write(", ".join([str(g[0]) for g in glyphs]) + "};\n\n")
 
 #-------------------------------------------------------------------------------
 # Write font struct
 #-------------------------------------------------------------------------------
-def writeFontStruct(f, name, glyphs):
+def writeFontStruct(f, name, glyphs, baseline):
   size = 0
   for g in glyphs:
     if g[1] > size:
       size = g[1]
+  pages = (size + 7) // 8
+  if baseline > size:
+    baseline = size
   f.write("const IO_font " + name + " = { \"" + name + "\", " + str(size))
-  f.write(", {\n")
-  for i in range(len(glyphs)):
-    f.write("  (IO_bitmap*)&" + name + "_glyph_" + str(i) + ",\n");
-  f.write("}};\n")
+  f.write(", " + str(baseline) + ", " + str(pages) + ",\n  ")
+  f.write(name + "_advance, " + name + "_offset, " + name + "_strip };\n")
 
 #-------------------------------------------------------------------------------
 # Start the show
@@ -191,7 +211,7 @@ def main():
   # Open the font file and generate the glyph data
   #-----------------------------------------------------------------------------
   font = ImageFont.truetype(fontfile, int(size))
-  glyphs = generateGlyphs(font);
+  glyphs, baseline = generateGlyphs(font);
 
   #-----------------------------------------------------------------------------
   # Open the result file and write the data
@@ -203,7 +223,8 @@ def main():
     fo = open(sys.argv[4], "w")
     writeHeader(fo)
     writeGlyphs(fo, name, glyphs)
-    writeFontStruct(fo, name, glyphs)
+    writeTables(fo, name, glyphs)
+    writeFontStruct(fo, name, glyphs, baseline)
     fo.close()
   except IOError, e:
     print "Error writing to " + output + ":", str(e)
@@ -44,9 +44,9 @@ int main()
     //--------------------------------------------------------------------------
     uint32_t choice;
     IO_print(&uart0,
-             "Choose the type of variable you want to enter (6 for help)\r\n");
+             "Choose the type of variable you want to enter (8 for help)\r\n");
     int32_t ret = IO_scan(&uart0, IO_UINT32, &choice, 0);
-    if(ret < 0 || choice > 6)
+    if(ret < 0 || choice > 8)
       continue;
     switch(choice) {
 
@@ -116,10 +116,32 @@ int main()
         break;
       }
 
+      //------------------------------------------------------------------------
+      // Float
+      //------------------------------------------------------------------------
+      case IO_FLOAT: {
+        float d;
+        IO_print(&uart0, "Enter a float\r\n");
+        ret = IO_scan(&uart0, IO_FLOAT, &d, 0);
+        PRINT(ret, d, "%f");
+        break;
+      }
+
+      //------------------------------------------------------------------------
+      // Q16.16
+      //------------------------------------------------------------------------
+      case IO_Q16: {
+        IO_q16 d;
+        IO_print(&uart0, "Enter a Q16.16 fixed point number\r\n");
+        ret = IO_scan(&uart0, IO_Q16, &d, 0);
+        PRINT(ret, d, "%k");
+        break;
+      }
+
       //------------------------------------------------------------------------
       // Help
       //------------------------------------------------------------------------
-      case 6: {
+      case 8: {
         IO_print(&uart0, "Valid scan types:\r\n");
         IO_print(&uart0, " * 0 - string\r\n");
         IO_print(&uart0, " * 1 - int32\r\n");
@@ -127,6 +149,8 @@ int main()
         IO_print(&uart0, " * 3 - uint32\r\n");
         IO_print(&uart0, " * 4 - uint64\r\n");
         IO_print(&uart0, " * 5 - double\r\n");
+        IO_print(&uart0, " * 6 - float\r\n");
+        IO_print(&uart0, " * 7 - Q16.16\r\n");
         break;
       }
     }
@@ -21,9 +21,11 @@
 #include <io/IO_sys.h>
 #include <io/IO_device.h>
 
-IO_io led[2];
+IO_io led[3];
 IO_io timer;
+IO_io periodic;
 int state = 0;
+int periodic_state = 0;
 
 void timer_event(IO_io *io, uint16_t event)
 {
@@ -40,6 +42,12 @@ void timer_event(IO_io *io, uint16_t event)
   IO_set(&timer, 500000000); // fire in half second
 }
 
+void periodic_event(IO_io *io, uint16_t event)
+{
+  periodic_state = !periodic_state;
+  IO_set(&led[2], periodic_state);
+}
+
 //------------------------------------------------------------------------------
 // Start the show
 //------------------------------------------------------------------------------
@@ -48,10 +56,14 @@ int main()
   IO_init(4096);
   IO_gpio_init(&led[0], 41, 0, 1);
   IO_gpio_init(&led[1], 42, 0, 1);
+  IO_gpio_init(&led[2], 43, 0, 1);
   IO_timer_init(&timer, 0);
   timer.event = timer_event;
   timer_event(0, 0);
 
+  IO_timer_init_periodic(&periodic, 1, 250000000); // fire every quarter second
+  periodic.event = periodic_event;
+
   while(1)
     IO_wait_for_interrupt();
 }
@@ -27,6 +27,7 @@ IO_io button[2];
 IO_io slider;
 IO_io timer;
 uint64_t sliderR = 0;
+uint32_t presses = 0;
 
 //------------------------------------------------------------------------------
 // Display results
@@ -42,6 +43,9 @@ void show()
   IO_print(&display, "Btn #0: %lld\r\n", btn0);
   IO_print(&display, "Btn #1: %lld\r\n", btn1);
   IO_print(&display, "ADC #0: %lld\r\n", sliderR);
+  IO_print(&display, "T #0: %llu\r\n", IO_gpio_timestamp(&button[0]));
+  IO_print(&display, "T #1: %llu\r\n", IO_gpio_timestamp(&button[1]));
+  IO_print(&display, "Presses: %lu\r\n", presses);
 
   // We should not do it in an interrupt handler, but since there is
   // nothing elso going on, then who cares.
@@ -71,6 +75,11 @@ void slider_event(IO_io *io, uint16_t event)
 //------------------------------------------------------------------------------
 void button_event(IO_io *io, uint16_t event)
 {
+  // the buttons are debounced, so every press counts once
+  uint64_t btn;
+  IO_get(io, &btn);
+  if(btn)
+    ++presses;
   show();
 }
 
@@ -86,6 +95,8 @@ int main()
   IO_button_init(&button[1], 1, IO_ASYNC);
   IO_timer_init(&timer, 0);
   IO_slider_init(&slider, 0, IO_ASYNC);
+  IO_gpio_debounce(&button[0], 10);
+  IO_gpio_debounce(&button[1], 10);
 
   button[0].event = button_event;
   button[1].event = button_event;
@@ -0,0 +1,463 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <io/IO_font.h>
+#include <drivers/pcd8544/pcd8544.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Off-screen pixel matrices; the devices are never initialized, we only use
+// the drawing functions
+//------------------------------------------------------------------------------
+static pcd8544 ref;
+static pcd8544 fast;
+
+//------------------------------------------------------------------------------
+// Pixel matrices of the printable characters followed by DEL, rendered from
+// the per-glyph IO_bitmaps with IO_display_print_bitmap before the glyphs were
+// packed into strips. The text starts at row 3 and wraps like display_write;
+// it takes two screens in every font.
+//------------------------------------------------------------------------------
+static const uint8_t expected[3][2][sizeof(fast.pixels)] = {
+  // DejaVuSans10
+  {
+    {
+      0x00, 0x00, 0x00, 0xf0, 0x00, 0x70, 0x00, 0x00, 0x40, 0xf0, 0x40, 0xc0,
+      0x70, 0x40, 0x00, 0xc0, 0xa0, 0xf0, 0x20, 0x20, 0x00, 0xf0, 0x90, 0xf0,
+      0x80, 0xc0, 0xb0, 0x80, 0x80, 0x00, 0x80, 0x60, 0x90, 0x90, 0x20, 0x00,
+      0x80, 0x00, 0x70, 0x00, 0xf0, 0x08, 0x00, 0x18, 0xe0, 0x00, 0x90, 0x60,
+      0xf0, 0x60, 0x90, 0x00, 0x80, 0x80, 0x80, 0xf0, 0x80, 0x80, 0x80, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x30, 0x00,
+      0xe0, 0x10, 0x10, 0x10, 0xe0, 0x00, 0x10, 0x10, 0xf0, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x80, 0x85, 0x80, 0x00, 0x00, 0x01, 0x87, 0x81, 0x81, 0x07,
+      0x01, 0x00, 0x00, 0x04, 0x84, 0x0f, 0x05, 0x83, 0x80, 0x80, 0x80, 0x06,
+      0x01, 0x00, 0x87, 0x84, 0x87, 0x80, 0x03, 0x86, 0x84, 0x84, 0x83, 0x82,
+      0x05, 0x00, 0x80, 0x80, 0x87, 0x08, 0x00, 0x0c, 0x83, 0x80, 0x80, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00,
+      0x0c, 0x00, 0x01, 0x01, 0x01, 0x00, 0x04, 0x00, 0x0c, 0x03, 0x00, 0x00,
+      0x03, 0x04, 0x84, 0x84, 0x83, 0x80, 0x04, 0x04, 0x07, 0x04, 0x04, 0x00,
+      0x00, 0x21, 0x30, 0x28, 0x24, 0x23, 0x00, 0x11, 0x24, 0x24, 0x24, 0x1b,
+      0x00, 0x0c, 0x0a, 0x09, 0x3f, 0x08, 0x00, 0x23, 0x22, 0x22, 0x22, 0x1c,
+      0x00, 0x1f, 0x25, 0x24, 0x24, 0x18, 0x00, 0x00, 0x20, 0x18, 0x06, 0x01,
+      0x00, 0x1b, 0x24, 0x24, 0x24, 0x1b, 0x00, 0x23, 0x24, 0x24, 0x34, 0x1f,
+      0x00, 0x22, 0x00, 0x62, 0x00, 0x04, 0x04, 0x0a, 0x0a, 0x0a, 0x11, 0x00,
+      0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x00, 0x11, 0x0a, 0x0a, 0x0a, 0x04,
+      0x04, 0x00, 0x00, 0x2c, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0xf0, 0x18, 0x0c, 0xe4, 0xa4, 0xe4, 0x84, 0xc8, 0x70, 0x00, 0x00,
+      0xe0, 0x58, 0x44, 0x58, 0xe0, 0x00, 0x00, 0xfc, 0x24, 0x24, 0x24, 0xd8,
+      0x00, 0x70, 0x88, 0x04, 0x04, 0x04, 0x88, 0x00, 0xfc, 0x04, 0x04, 0x04,
+      0x8c, 0xf8, 0x00, 0xfc, 0x24, 0x24, 0x24, 0x24, 0x00, 0xfc, 0x24, 0x24,
+      0x24, 0x00, 0xf8, 0x8c, 0x04, 0x24, 0x24, 0xe8, 0x00, 0xfc, 0x20, 0x20,
+      0x20, 0x20, 0xfc, 0x00, 0xfc, 0x00, 0x00, 0x00, 0xfc, 0x00, 0xfc, 0x20,
+      0x50, 0x88, 0x04, 0x00, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0xe1, 0xc3, 0x06, 0x04, 0x04, 0xc4, 0xe2, 0x00, 0xe0, 0x40, 0x81,
+      0x00, 0x00, 0xe0, 0x00, 0xc0, 0x61, 0x20, 0x21, 0x61, 0xc1, 0x01, 0xe0,
+      0x20, 0x20, 0x20, 0xc1, 0x01, 0xc1, 0x60, 0x20, 0x21, 0x61, 0xc1, 0x01,
+      0xe1, 0x20, 0x20, 0x21, 0xc1, 0x01, 0x01, 0xc1, 0x20, 0x21, 0x20, 0x40,
+      0x00, 0x20, 0x20, 0xe1, 0x21, 0x21, 0x01, 0xe0, 0x00, 0x01, 0x00, 0x00,
+      0xe0, 0x00, 0x61, 0x80, 0x01, 0x00, 0x04, 0x84, 0x63, 0x00, 0x61, 0x80,
+      0x00, 0x80, 0x61, 0x80, 0x01, 0x81, 0x61, 0x01, 0x01, 0x00, 0x00, 0x00,
+      0x00, 0x0f, 0x00, 0x03, 0x04, 0x03, 0x00, 0x0f, 0x00, 0x0f, 0x00, 0x01,
+      0x02, 0x04, 0x0f, 0x00, 0x07, 0x0c, 0x08, 0x08, 0x0c, 0x07, 0x00, 0x0f,
+      0x01, 0x01, 0x01, 0x00, 0x00, 0x07, 0x0c, 0x08, 0x08, 0x14, 0x03, 0x00,
+      0x0f, 0x01, 0x01, 0x03, 0x04, 0x08, 0x00, 0x04, 0x09, 0x09, 0x09, 0x06,
+      0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x07, 0x08, 0x08, 0x08, 0x08,
+      0x07, 0x00, 0x00, 0x01, 0x06, 0x08, 0x06, 0x01, 0x00, 0x00, 0x00, 0x03,
+      0x0c, 0x03, 0x00, 0x03, 0x0c, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {
+      0x00, 0x10, 0x30, 0xc0, 0xc0, 0x30, 0x10, 0x00, 0x10, 0x20, 0x40, 0x80,
+      0x40, 0x20, 0x10, 0x00, 0x10, 0x10, 0x90, 0xd0, 0x30, 0x10, 0x00, 0xf8,
+      0x08, 0x00, 0x30, 0xc0, 0x00, 0x00, 0x08, 0xf8, 0x00, 0x40, 0x20, 0x10,
+      0x10, 0x20, 0x40, 0x00, 0x00, 0x40, 0xf0, 0x40, 0xc0, 0x70, 0x40, 0x00,
+      0x00, 0x40, 0xf0, 0x40, 0xc0, 0x70, 0x40, 0x00, 0x00, 0x40, 0x40, 0x40,
+      0x80, 0x00, 0xf8, 0x40, 0x40, 0x40, 0x80, 0x00, 0x80, 0x40, 0x40, 0x40,
+      0x00, 0x80, 0x40, 0x40, 0x40, 0xf8, 0x00, 0x80, 0x40, 0x40, 0x40, 0x80,
+      0x00, 0x04, 0xc6, 0x41, 0x41, 0x06, 0x04, 0x00, 0x00, 0x00, 0x00, 0x07,
+      0xc0, 0x00, 0x00, 0x00, 0x04, 0x06, 0x45, 0x04, 0x04, 0x44, 0x00, 0xcf,
+      0x08, 0x00, 0x00, 0x03, 0xcc, 0x00, 0x08, 0x0f, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01, 0x01, 0x07, 0x01, 0x00, 0x00,
+      0x01, 0x07, 0x01, 0x01, 0x07, 0x01, 0x00, 0x00, 0x06, 0x05, 0x05, 0x05,
+      0x07, 0x00, 0x07, 0x04, 0x04, 0x04, 0x03, 0x00, 0x03, 0x04, 0x04, 0x04,
+      0x00, 0x03, 0x84, 0x04, 0x04, 0x07, 0x00, 0x03, 0x05, 0x05, 0x05, 0x05,
+      0x00, 0x02, 0x3f, 0x02, 0x00, 0x00, 0x1c, 0xa2, 0xa2, 0xa2, 0x7e, 0x00,
+      0x3f, 0x02, 0x02, 0x02, 0x3c, 0x00, 0x3e, 0x00, 0x80, 0xfe, 0x00, 0x3f,
+      0x08, 0x14, 0x22, 0x00, 0x3f, 0x00, 0x3e, 0x02, 0x02, 0x02, 0x3c, 0x02,
+      0x02, 0x02, 0x3c, 0x00, 0x3e, 0x02, 0x02, 0x02, 0x3c, 0x00, 0x1c, 0x22,
+      0x22, 0x22, 0x1c, 0x00, 0xfe, 0x22, 0x22, 0x22, 0x1c, 0x00, 0x1c, 0x22,
+      0x22, 0x22, 0xfe, 0x00, 0x3e, 0x02, 0x02, 0x00, 0x26, 0x2a, 0x2a, 0x3a,
+      0x00, 0x02, 0x3f, 0x22, 0x22, 0x00, 0x1e, 0x20, 0x20, 0x20, 0x3e, 0x00,
+      0x00, 0x30, 0xc0, 0x00, 0xc0, 0x30, 0x00, 0x70, 0x80, 0x60, 0x10, 0x60,
+      0x80, 0x70, 0x00, 0x10, 0xa0, 0x40, 0xa0, 0x10, 0x00, 0x30, 0xc0, 0x00,
+      0xc0, 0x30, 0x00, 0x10, 0x90, 0x50, 0x30, 0x00, 0x20, 0x20, 0xde, 0x02,
+      0x00, 0xfe, 0x00, 0x02, 0xde, 0x20, 0x20, 0x00, 0x40, 0x20, 0x20, 0x40,
+      0x40, 0x20, 0x00, 0x40, 0xd0, 0x7c, 0x50, 0xf0, 0x5c, 0x10, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+      0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x04, 0x03,
+      0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x03, 0x02,
+      0x00, 0x07, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    }
+  },
+  // DejaVuSerif10
+  {
+    {
+      0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x70, 0x00, 0x00, 0x40, 0xf0,
+      0x40, 0xe0, 0x50, 0x40, 0x00, 0x60, 0xa0, 0xf0, 0xa0, 0x20, 0x00, 0xf0,
+      0x90, 0xf0, 0x80, 0xc0, 0xb0, 0x80, 0x80, 0x00, 0x80, 0x60, 0x90, 0x90,
+      0x20, 0x80, 0x80, 0x80, 0x00, 0x70, 0x00, 0xf0, 0x08, 0x00, 0x18, 0xe0,
+      0x00, 0xa0, 0xc0, 0xf0, 0xc0, 0xa0, 0x00, 0x80, 0x80, 0x80, 0xf0, 0x80,
+      0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0xc0, 0x30, 0x00, 0xe0, 0x10, 0x10, 0x10, 0xe0, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x80, 0x00, 0x00, 0x05, 0x80, 0x80, 0x80, 0x01, 0x07, 0x01,
+      0x87, 0x81, 0x81, 0x00, 0x00, 0x02, 0x04, 0x0f, 0x84, 0x03, 0x00, 0x80,
+      0x80, 0x86, 0x81, 0x80, 0x07, 0x04, 0x87, 0x80, 0x83, 0x04, 0x04, 0x85,
+      0x87, 0x82, 0x85, 0x84, 0x00, 0x00, 0x80, 0x87, 0x88, 0x00, 0x0c, 0x03,
+      0x80, 0x80, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00,
+      0x00, 0x00, 0x00, 0x08, 0x04, 0x00, 0x01, 0x01, 0x01, 0x00, 0x04, 0x00,
+      0x0c, 0x03, 0x00, 0x00, 0x03, 0x04, 0x04, 0x84, 0x83, 0x80, 0x00, 0x00,
+      0x00, 0x21, 0x3f, 0x20, 0x00, 0x21, 0x30, 0x28, 0x24, 0x33, 0x00, 0x11,
+      0x20, 0x24, 0x24, 0x1b, 0x00, 0x08, 0x0e, 0x29, 0x3f, 0x28, 0x00, 0x13,
+      0x22, 0x22, 0x22, 0x1c, 0x00, 0x1f, 0x24, 0x24, 0x24, 0x19, 0x00, 0x01,
+      0x20, 0x18, 0x06, 0x01, 0x00, 0x1b, 0x2c, 0x24, 0x2c, 0x1b, 0x00, 0x13,
+      0x24, 0x24, 0x24, 0x1f, 0x00, 0x24, 0x00, 0x40, 0x24, 0x00, 0x04, 0x0c,
+      0x0a, 0x0a, 0x12, 0x11, 0x00, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x00,
+      0x11, 0x12, 0x0a, 0x0a, 0x0c, 0x04, 0x00, 0x00, 0x2c, 0x04, 0x03, 0x00,
+      0x00, 0xf0, 0x18, 0xe8, 0x14, 0x14, 0x24, 0xf4, 0x08, 0xf0, 0x00, 0x00,
+      0xc0, 0x78, 0x4c, 0x70, 0xc0, 0x00, 0x00, 0x04, 0xfc, 0x24, 0x24, 0x24,
+      0xd8, 0x00, 0x70, 0x88, 0x04, 0x04, 0x04, 0x88, 0x00, 0x04, 0xfc, 0x04,
+      0x04, 0x04, 0x88, 0x70, 0x00, 0x04, 0xfc, 0x24, 0x24, 0x24, 0x8c, 0x00,
+      0x04, 0xfc, 0x24, 0x24, 0x24, 0x0c, 0x00, 0x70, 0x88, 0x04, 0x04, 0x04,
+      0x44, 0xc8, 0x00, 0x04, 0xfc, 0x24, 0x20, 0x20, 0x24, 0xfc, 0x04, 0x00,
+      0x04, 0xfc, 0x04, 0x00, 0x00, 0x04, 0xfc, 0x04, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x21, 0xe3, 0x26, 0x85, 0x65, 0x25, 0x05, 0x01, 0x20, 0xe0, 0x21,
+      0x01, 0x00, 0x00, 0x01, 0x21, 0xe1, 0x60, 0x81, 0x01, 0x81, 0x61, 0xe1,
+      0x20, 0x00, 0x20, 0xe1, 0x41, 0x81, 0x01, 0x20, 0xe0, 0x21, 0x01, 0x81,
+      0x41, 0x21, 0x20, 0x20, 0x40, 0x81, 0x01, 0x21, 0xe1, 0x21, 0x21, 0x20,
+      0xc1, 0x01, 0x81, 0x40, 0x20, 0x20, 0x20, 0x40, 0x80, 0x01, 0x21, 0xe1,
+      0x21, 0x20, 0x20, 0xc1, 0x01, 0x01, 0xc0, 0x20, 0x21, 0x21, 0x41, 0x00,
+      0x61, 0x21, 0x21, 0xe0, 0x26, 0x24, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x08, 0x0f, 0x09, 0x02, 0x04, 0x08, 0x08, 0x00, 0x08, 0x0f, 0x08,
+      0x08, 0x08, 0x0c, 0x00, 0x08, 0x0f, 0x08, 0x01, 0x06, 0x01, 0x08, 0x0f,
+      0x08, 0x00, 0x08, 0x0f, 0x08, 0x01, 0x03, 0x06, 0x0f, 0x00, 0x00, 0x03,
+      0x04, 0x08, 0x08, 0x08, 0x04, 0x03, 0x00, 0x08, 0x0f, 0x09, 0x01, 0x01,
+      0x00, 0x00, 0x03, 0x04, 0x08, 0x08, 0x18, 0x24, 0x03, 0x00, 0x08, 0x0f,
+      0x09, 0x01, 0x03, 0x04, 0x08, 0x00, 0x04, 0x09, 0x09, 0x09, 0x06, 0x00,
+      0x00, 0x00, 0x08, 0x0f, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {
+      0x00, 0x10, 0xf0, 0x10, 0x00, 0x00, 0x10, 0xf0, 0x10, 0x00, 0x10, 0x70,
+      0x90, 0x00, 0x90, 0x70, 0x10, 0x00, 0x10, 0xf0, 0x10, 0xc0, 0x30, 0x30,
+      0xc0, 0x10, 0xf0, 0x10, 0x00, 0x10, 0x30, 0x50, 0x80, 0x50, 0x30, 0x10,
+      0x00, 0x10, 0x30, 0x50, 0x80, 0x50, 0x30, 0x10, 0x00, 0x30, 0x10, 0x90,
+      0xd0, 0x30, 0x10, 0x00, 0xf8, 0x08, 0x00, 0x30, 0xc0, 0x00, 0x00, 0x08,
+      0xf8, 0x00, 0x40, 0x20, 0x10, 0x10, 0x20, 0x40, 0x00, 0x00, 0x40, 0xf0,
+      0x40, 0xe0, 0x50, 0x40, 0x00, 0x00, 0x40, 0xf0, 0x40, 0xe0, 0x50, 0x40,
+      0x00, 0x00, 0x03, 0x04, 0x04, 0x04, 0x04, 0x43, 0xc0, 0x00, 0x00, 0x00,
+      0x01, 0x06, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x41, 0xc0, 0x00,
+      0x01, 0x07, 0x00, 0x00, 0x00, 0x04, 0x06, 0x05, 0xc0, 0x45, 0x46, 0x04,
+      0x00, 0x00, 0x00, 0x04, 0x07, 0x04, 0x40, 0xc0, 0x00, 0x04, 0x06, 0x05,
+      0x04, 0x04, 0x86, 0x00, 0x0f, 0x08, 0x00, 0x80, 0x03, 0x4c, 0xc0, 0x08,
+      0x0f, 0x00, 0x00, 0x00, 0x40, 0xc0, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01,
+      0x07, 0x01, 0x01, 0x00, 0x00, 0x01, 0x07, 0x01, 0x07, 0x01, 0x01, 0x00,
+      0x00, 0x38, 0x2a, 0x2a, 0x3c, 0x20, 0x00, 0x20, 0x3f, 0x22, 0x22, 0x1c,
+      0x00, 0x1c, 0x22, 0x22, 0x22, 0x24, 0x00, 0x1c, 0x22, 0x22, 0x3f, 0x20,
+      0x00, 0x1c, 0x2a, 0x2a, 0x2a, 0x2c, 0x00, 0x22, 0x3f, 0x22, 0x00, 0x00,
+      0x9c, 0xa2, 0xa2, 0x7e, 0x02, 0x00, 0x20, 0x3f, 0x22, 0x02, 0x3e, 0x20,
+      0x00, 0x22, 0x3e, 0x20, 0x00, 0x80, 0x82, 0xfe, 0x00, 0x20, 0x3f, 0x28,
+      0x0e, 0x32, 0x20, 0x00, 0x20, 0x3f, 0x20, 0x00, 0x22, 0x3e, 0x22, 0x02,
+      0x3e, 0x22, 0x02, 0x3e, 0x20, 0x00, 0x22, 0x3e, 0x22, 0x02, 0x3e, 0x20,
+      0x00, 0xe0, 0x10, 0x10, 0x10, 0xe0, 0x00, 0x10, 0xf0, 0x10, 0x10, 0xe0,
+      0x00, 0xe0, 0x10, 0x10, 0xf0, 0x10, 0x00, 0x10, 0xf0, 0x10, 0x30, 0x00,
+      0x30, 0x50, 0x50, 0x90, 0x00, 0x10, 0xfc, 0x10, 0x80, 0x00, 0x10, 0xf0,
+      0x00, 0x10, 0xf0, 0x00, 0x00, 0x10, 0x70, 0x90, 0x80, 0x70, 0x10, 0x00,
+      0x10, 0x70, 0x80, 0x70, 0x80, 0x70, 0x10, 0x00, 0x10, 0xb0, 0x40, 0xb0,
+      0x10, 0x00, 0x10, 0x70, 0x80, 0x80, 0x70, 0x10, 0x00, 0x30, 0x90, 0x50,
+      0x30, 0x90, 0x00, 0x20, 0x20, 0xde, 0x02, 0x00, 0xfe, 0x00, 0x00, 0x00,
+      0x00, 0x10, 0x11, 0xf1, 0x01, 0x00, 0x00, 0x04, 0x07, 0x05, 0x01, 0x00,
+      0x00, 0x00, 0x01, 0x85, 0xe7, 0x84, 0xc0, 0xa1, 0x81, 0x01, 0x00, 0x00,
+      0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00, 0x00, 0x01,
+      0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x01,
+      0x01, 0x00, 0x04, 0x04, 0x03, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01,
+      0x01, 0x01, 0x00, 0x00, 0x00, 0x03, 0x02, 0x00, 0x07, 0x00, 0x00, 0x00,
+      0x00, 0x10, 0x10, 0x1e, 0x01, 0x01, 0x00, 0x02, 0x01, 0x01, 0x02, 0x02,
+      0x02, 0x00, 0x02, 0x0e, 0x03, 0x0e, 0x03, 0x02, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    }
+  },
+  // SilkScreen8
+  {
+    {
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x30, 0x00, 0xa0, 0xf0, 0xa0,
+      0xf0, 0xa0, 0x00, 0x20, 0x50, 0x58, 0x90, 0x00, 0x30, 0xb0, 0x40, 0xb0,
+      0x80, 0x00, 0xa0, 0x50, 0x58, 0x10, 0x00, 0x30, 0x00, 0xe0, 0x10, 0x00,
+      0x10, 0xe0, 0x00, 0xa0, 0x40, 0xf0, 0x40, 0xa0, 0x00, 0x40, 0x40, 0xf0,
+      0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x40, 0x00, 0x00, 0x00,
+      0x80, 0x40, 0x30, 0x00, 0xe0, 0x10, 0x10, 0xe0, 0x00, 0x10, 0xf0, 0x00,
+      0x00, 0x90, 0x50, 0x50, 0x20, 0x00, 0x10, 0x50, 0x50, 0xa0, 0x00, 0x00,
+      0x00, 0xf0, 0x80, 0xf0, 0x80, 0x01, 0x70, 0x50, 0x50, 0x90, 0x01, 0xe0,
+      0x51, 0x50, 0x80, 0x01, 0x13, 0x91, 0x51, 0x30, 0x00, 0xa1, 0x50, 0x51,
+      0xa1, 0x00, 0x20, 0x51, 0x53, 0xe1, 0x00, 0xa0, 0x00, 0x00, 0xa1, 0x00,
+      0x41, 0xa0, 0x10, 0x00, 0xa0, 0xa1, 0xa0, 0x00, 0x10, 0xa0, 0x40, 0x01,
+      0x10, 0x50, 0x50, 0x22, 0x01, 0xe0, 0x10, 0x70, 0x50, 0x20, 0x01, 0xe0,
+      0x51, 0x50, 0xe0, 0x00, 0xf0, 0x51, 0x51, 0xa0, 0x00, 0xe1, 0x11, 0x11,
+      0xa0, 0x01, 0xf1, 0x11, 0x11, 0xe0, 0x01, 0xf1, 0x51, 0x50, 0x00, 0x00,
+      0x00, 0xf0, 0x50, 0x51, 0x00, 0xe0, 0x11, 0x51, 0xd1, 0x00, 0xf0, 0x40,
+      0x41, 0xf1, 0x00, 0xf0, 0x00, 0x81, 0x00, 0x00, 0xf0, 0x00, 0xf1, 0x41,
+      0xa0, 0x10, 0x00, 0xf1, 0x01, 0x00, 0x00, 0xf0, 0x20, 0x41, 0x20, 0xf0,
+      0x00, 0xf0, 0x21, 0x40, 0x80, 0xf0, 0x00, 0xe0, 0x11, 0x10, 0xe0, 0x00,
+      0xf0, 0x51, 0x50, 0x20, 0x00, 0xe0, 0x11, 0x11, 0xe1, 0x00, 0xf0, 0x51,
+      0xd0, 0x20, 0x01, 0x20, 0x51, 0x51, 0x91, 0x00, 0x10, 0xf0, 0x11, 0x01,
+      0xf0, 0x00, 0x01, 0xf1, 0x01, 0x30, 0xc0, 0x01, 0xc1, 0x31, 0x00, 0x00,
+      0x00, 0xf1, 0x00, 0xe0, 0x00, 0xf0, 0x01, 0x11, 0xa0, 0x40, 0xa1, 0x10,
+      0x00, 0x11, 0x20, 0xc1, 0x20, 0x10, 0x01, 0x91, 0x50, 0x30, 0x01, 0xf0,
+      0x10, 0x01, 0x30, 0x41, 0x81, 0x01, 0x10, 0xf1, 0x00, 0x20, 0x10, 0x21,
+      0x00, 0xa1, 0xf0, 0xa0, 0xf0, 0xa1, 0x00, 0xa0, 0xf1, 0xa1, 0xf0, 0xa0,
+      0x01, 0xe0, 0x50, 0x50, 0xe0, 0x00, 0xf1, 0x51, 0x52, 0xa0, 0x01, 0xe0,
+      0x10, 0x11, 0xa0, 0x01, 0xf1, 0x11, 0x10, 0xe0, 0x00, 0xf1, 0x50, 0x50,
+      0x00, 0xf1, 0x51, 0x50, 0x00, 0xe0, 0x10, 0x51, 0xd0, 0x00, 0x00, 0x00,
+      0x00, 0xf0, 0x41, 0x40, 0xf1, 0x00, 0xf0, 0x01, 0x80, 0x00, 0x00, 0xf1,
+      0x00, 0xf0, 0x40, 0xa1, 0x10, 0x00, 0xf0, 0x01, 0x01, 0x01, 0xf0, 0x21,
+      0x41, 0x20, 0xf0, 0x00, 0xf1, 0x20, 0x41, 0x81, 0xf0, 0x00, 0xe0, 0x10,
+      0x10, 0xe0, 0x01, 0xf0, 0x51, 0x50, 0x20, 0x00, 0xe1, 0x10, 0x11, 0xe0,
+      0x00, 0xf1, 0x50, 0xd0, 0x21, 0x00, 0x21, 0x51, 0x51, 0x90, 0x00, 0x10,
+      0xf1, 0x11, 0x00, 0xf0, 0x01, 0x01, 0xf1, 0x00, 0x30, 0xc1, 0x01, 0xc1,
+      0x30, 0x01, 0xf0, 0x00, 0xe0, 0x00, 0xf1, 0x01, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00,
+      0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x01, 0x00, 0x01, 0x00,
+      0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01,
+      0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02,
+      0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
+      0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+      0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {
+      0x00, 0x10, 0xa0, 0x40, 0xa0, 0x10, 0x00, 0x10, 0x20, 0xc0, 0x20, 0x10,
+      0x00, 0x90, 0x50, 0x30, 0x00, 0x40, 0xb0, 0x10, 0x00, 0xf8, 0x00, 0x10,
+      0xb0, 0x40, 0x00, 0x20, 0x10, 0x20, 0x10, 0x00, 0xa0, 0xf0, 0xa0, 0xf0,
+      0xa0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+      0x00, 0x01, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x03, 0x00, 0x01,
+      0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+// Render the text pixel by pixel from the strip
+//------------------------------------------------------------------------------
+static void render_ref(const IO_font *font, const char *text, uint16_t x,
+  uint16_t y)
+{
+  for(; *text; ++text) {
+    uint8_t glyph = IO_font_get_glyph(*text);
+    uint8_t width = font->advance[glyph];
+    const uint8_t *data = font->strip + font->offset[glyph];
+    if(x + width > 84) {
+      x = 0;
+      y += font->size + 1;
+    }
+    if(y + font->size > 48)
+      break;
+    for(int i = 0; i < width; ++i)
+      for(int j = 0; j < font->size; ++j) {
+        uint8_t byte = data[i*font->pages + j/8];
+        PCD8544_put_pixel(&ref, x+i, y+j, !(byte & (1 << (j%8))));
+      }
+    x += width;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Render the text column by column; returns the part that did not fit
+//------------------------------------------------------------------------------
+static const char *render_fast(const IO_font *font, const char *text,
+  uint16_t x, uint16_t y)
+{
+  for(; *text; ++text) {
+    uint8_t glyph = IO_font_get_glyph(*text);
+    uint8_t width = font->advance[glyph];
+    if(x + width > 84) {
+      x = 0;
+      y += font->size + 1;
+    }
+    if(y + font->size > 48)
+      break;
+    PCD8544_blit(&fast, x, y, width, font->size,
+                 font->strip + font->offset[glyph]);
+    x += width;
+  }
+  return text;
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_io uart0;
+  IO_uart_init(&uart0, 0, 0, 115200);
+
+  const char *fonts[] = {"DejaVuSans10", "DejaVuSerif10", "SilkScreen8"};
+
+  //----------------------------------------------------------------------------
+  // All the printable characters and some that are not
+  //----------------------------------------------------------------------------
+  char text[128];
+  int len = 0;
+  for(int i = 1; i < 128; ++i)
+    if(i != '\r' && i != '\n')
+      text[len++] = i;
+  text[len] = 0;
+
+  //----------------------------------------------------------------------------
+  // Compare with the output of the per-glyph bitmaps
+  //----------------------------------------------------------------------------
+  char printable[97];
+  for(int i = 0; i < 95; ++i)
+    printable[i] = i + 32;
+  printable[95] = 127;
+  printable[96] = 0;
+
+  for(int f = 0; f < 3; ++f) {
+    const IO_font *font = IO_font_get_by_name(fonts[f]);
+    uint32_t failed = 0;
+    const char *str = printable;
+    for(int i = 0; i < 2; ++i) {
+      memset(fast.pixels, 0, sizeof(fast.pixels));
+      str = render_fast(font, str, 0, 3);
+      if(memcmp(fast.pixels, expected[f][i], sizeof(fast.pixels)))
+        ++failed;
+    }
+    if(*str)
+      ++failed;
+    IO_print(&uart0, "%s reference: %s (%u mismatches)\r\n", fonts[f],
+             failed ? "FAILED" : "OK", failed);
+  }
+
+  //----------------------------------------------------------------------------
+  // Render at every vertical sub-byte offset over a dirty background and
+  // compare the pixel matrices
+  //----------------------------------------------------------------------------
+  for(int f = 0; f < 3; ++f) {
+    const IO_font *font = IO_font_get_by_name(fonts[f]);
+    uint32_t failed = 0;
+    for(uint16_t y = 0; y < 48; ++y)
+      for(uint16_t x = 0; x < 84; x += 5) {
+        memset(ref.pixels, 0xa5, sizeof(ref.pixels));
+        memset(fast.pixels, 0xa5, sizeof(fast.pixels));
+        const char *str = text + (x + y) % len;
+        render_ref(font, str, x, y);
+        render_fast(font, str, x, y);
+        if(memcmp(ref.pixels, fast.pixels, sizeof(ref.pixels)))
+          ++failed;
+      }
+    IO_print(&uart0, "%s: %s (%u mismatches)\r\n", fonts[f],
+             failed ? "FAILED" : "OK", failed);
+  }
+
+  //----------------------------------------------------------------------------
+  // Pre-render single lines off-screen and blit them in one go
+  //----------------------------------------------------------------------------
+  for(int f = 0; f < 3; ++f) {
+    const IO_font *font = IO_font_get_by_name(fonts[f]);
+    uint32_t failed = 0;
+    uint8_t pixels[168];
+    IO_bitmap bmp;
+    bmp.data = pixels;
+    for(int i = 0; i < len; ++i) {
+      char line[16];
+      int  n = 0;
+      for(; n < 15 && text[i+n]; ++n)
+        line[n] = text[i+n];
+      line[n] = 0;
+      while(IO_font_get_width(font, line) > 84)
+        line[--n] = 0;
+
+      memset(ref.pixels, 0xa5, sizeof(ref.pixels));
+      memset(fast.pixels, 0xa5, sizeof(fast.pixels));
+      uint16_t y = i % (48 - font->size);
+      render_ref(font, line, 0, y);
+      IO_font_render(font, line, &bmp, sizeof(pixels));
+      PCD8544_blit(&fast, 0, y, bmp.width, bmp.height, pixels);
+      if(memcmp(ref.pixels, fast.pixels, sizeof(ref.pixels)))
+        ++failed;
+    }
+    IO_print(&uart0, "%s pre-rendered: %s (%u mismatches)\r\n", fonts[f],
+             failed ? "FAILED" : "OK", failed);
+  }
+
+  while(1)
+    IO_wait_for_interrupt();
+}
@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <drivers/pcd8544/pcd8544.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Off-screen pixel matrices; the devices are never initialized, we only use
+// the drawing functions
+//------------------------------------------------------------------------------
+static pcd8544 ref;
+static pcd8544 fast;
+
+//------------------------------------------------------------------------------
+// Random test bitmaps
+//------------------------------------------------------------------------------
+static uint8_t bmp_data[30*3];
+static uint8_t mask_data[30*3];
+
+//------------------------------------------------------------------------------
+// Reference implementations working pixel by pixel
+//------------------------------------------------------------------------------
+static void ref_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, int op)
+{
+  for(int i = 0; i < w; ++i)
+    for(int j = 0; j < h; ++j) {
+      uint32_t argb = 0;
+      if(op == 2) {
+        if(PCD8544_get_pixel(&ref, x+i, y+j, &argb))
+          continue;
+        argb = !argb;
+      }
+      else
+        argb = op;
+      PCD8544_put_pixel(&ref, x+i, y+j, argb);
+    }
+}
+
+static void ref_blit(uint16_t x, uint16_t y, const IO_bitmap *bmp,
+  const IO_bitmap *mask)
+{
+  const uint8_t *data = bmp->data;
+  uint8_t pages = (bmp->height + 7) / 8;
+  for(int i = 0; i < bmp->width; ++i)
+    for(int j = 0; j < bmp->height; ++j) {
+      uint16_t byte = i*pages + j/8;
+      uint8_t  bit  = 1 << (j%8);
+      if(mask && !(((uint8_t *)mask->data)[byte] & bit))
+        continue;
+      PCD8544_put_pixel(&ref, x+i, y+j, !(data[byte] & bit));
+    }
+}
+
+static void ref_copy(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+  uint16_t to_x, uint16_t to_y)
+{
+  static pcd8544 tmp;
+  memcpy(&tmp, &ref, sizeof(tmp));
+  for(int i = 0; i < w; ++i)
+    for(int j = 0; j < h; ++j) {
+      uint32_t argb;
+      if(PCD8544_get_pixel(&tmp, x+i, y+j, &argb))
+        continue;
+      PCD8544_put_pixel(&ref, to_x+i, to_y+j, argb);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_io uart0;
+  IO_uart_init(&uart0, 0, 0, 115200);
+
+  const char *names[] = {"fill", "clear", "invert", "hline", "vline", "blit",
+                         "masked", "copy"};
+  uint32_t failed[8];
+  memset(failed, 0, sizeof(failed));
+
+  IO_rng_seed(42);
+  for(int run = 0; run < 2000; ++run) {
+    for(int i = 0; i < sizeof(ref.pixels); ++i)
+      ((uint8_t *)ref.pixels)[i] = IO_random();
+    for(int i = 0; i < sizeof(bmp_data); ++i) {
+      bmp_data[i]  = IO_random();
+      mask_data[i] = IO_random();
+    }
+    memcpy(fast.pixels, ref.pixels, sizeof(ref.pixels));
+
+    int op = run % 8;
+    uint16_t x = IO_random() % 84;
+    uint16_t y = IO_random() % 48;
+    uint16_t w = IO_random() % 30 + 1;
+    uint16_t h = IO_random() % 24 + 1;
+    IO_bitmap bmp  = {w, h, 1, bmp_data};
+    IO_bitmap mask = {w, h, 1, mask_data};
+
+    switch(op) {
+      case 0:
+        ref_rect(x, y, w, h, 0);
+        PCD8544_fill_rect(&fast, x, y, w, h);
+        break;
+      case 1:
+        ref_rect(x, y, w, h, 1);
+        PCD8544_clear_rect(&fast, x, y, w, h);
+        break;
+      case 2:
+        ref_rect(x, y, w, h, 2);
+        PCD8544_invert_rect(&fast, x, y, w, h);
+        break;
+      case 3:
+        ref_rect(x, y, w, 1, 0);
+        PCD8544_hline(&fast, x, y, w);
+        break;
+      case 4:
+        ref_rect(x, y, 1, h, 0);
+        PCD8544_vline(&fast, x, y, h);
+        break;
+      case 5:
+        ref_blit(x, y, &bmp, 0);
+        PCD8544_blit_masked(&fast, x, y, &bmp, 0);
+        break;
+      case 6:
+        ref_blit(x, y, &bmp, &mask);
+        PCD8544_blit_masked(&fast, x, y, &bmp, &mask);
+        break;
+      case 7: {
+        uint16_t to_x = IO_random() % 84;
+        uint16_t to_y = IO_random() % 48;
+        ref_copy(x, y, w, h, to_x, to_y);
+        PCD8544_copy_rect(&fast, x, y, w, h, to_x, to_y);
+        break;
+      }
+    }
+
+    if(memcmp(ref.pixels, fast.pixels, sizeof(ref.pixels)))
+      ++failed[op];
+  }
+
+  for(int i = 0; i < 8; ++i)
+    IO_print(&uart0, "%s: %s (%u mismatches)\r\n", names[i],
+             failed[i] ? "FAILED" : "OK", failed[i]);
+
+  while(1)
+    IO_wait_for_interrupt();
+}
@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <game/SI_collision.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Test objects
+//------------------------------------------------------------------------------
+#define MAX_OBJECTS 255
+#define FRAMES      100
+
+static SI_object  objects[MAX_OBJECTS];
+static SI_object *object_ptrs[MAX_OBJECTS];
+static SI_scene   scene;
+
+static uint32_t num_pairs;
+static uint32_t checksum;
+
+//------------------------------------------------------------------------------
+// Count the reported pairs
+//------------------------------------------------------------------------------
+static void collision(SI_object *obj1, SI_object *obj2, uint16_t x,
+  uint16_t y)
+{
+  uint32_t i1 = obj1 - objects;
+  uint32_t i2 = obj2 - objects;
+  ++num_pairs;
+  checksum += i1 < i2 ? i1 * 256 + i2 : i2 * 256 + i1;
+}
+
+//------------------------------------------------------------------------------
+// All pairs, as it used to be done
+//------------------------------------------------------------------------------
+static void collision_naive(SI_scene *scene)
+{
+  for(int i = 0; i < scene->num_objects; ++i) {
+    SI_object *obj1 = scene->objects[i];
+    for(int j = i + 1; j < scene->num_objects; ++j) {
+      SI_object *obj2 = scene->objects[j];
+      if(!(obj1->mask & obj2->layer) && !(obj2->mask & obj1->layer))
+        continue;
+      if(obj1->x < obj2->x + obj2->width &&
+         obj1->x + obj1->width > obj2->x &&
+         obj1->y < obj2->y + obj2->height &&
+         obj1->height + obj1->y > obj2->y)
+        scene->collision(obj1, obj2, 0, 0);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Find the first contact point pixel by pixel
+//------------------------------------------------------------------------------
+static int get_pixel(const SI_object *obj, uint16_t x, uint16_t y)
+{
+  if(x < obj->x || x >= obj->x + obj->width ||
+     y < obj->y || y >= obj->y + obj->height)
+    return 0;
+  if(!obj->shape)
+    return 1;
+  x -= obj->x;
+  y -= obj->y;
+  const uint8_t *data = obj->shape->data;
+  uint8_t pages = (obj->shape->height + 7) / 8;
+  return data[x*pages + y/8] & (1 << (y%8));
+}
+
+static int collision_pixel_naive(const SI_object *obj1, const SI_object *obj2,
+  uint16_t *x, uint16_t *y)
+{
+  for(uint16_t i = 0; i < 84; ++i)
+    for(uint16_t j = 0; j < 96; ++j)
+      if(get_pixel(obj1, i, j) && get_pixel(obj2, i, j)) {
+        *x = i;
+        *y = j;
+        return 1;
+      }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Compare the narrow phase against the pixel-by-pixel check for random
+// shapes of up to max_height rows; the first object starts above max_y0, the
+// second one at or below min_y1, and every eighth first object is a box with
+// no shape
+//------------------------------------------------------------------------------
+static uint8_t shape_data[2][16*6];
+
+static uint32_t test_pixel(uint16_t max_height, uint16_t max_y0,
+  uint16_t min_y1)
+{
+  uint32_t failed = 0;
+  for(int t = 0; t < 1000; ++t) {
+    SI_object obj[2];
+    IO_bitmap shape[2];
+    memset(obj, 0, sizeof(obj));
+    for(int i = 0; i < 2; ++i) {
+      for(int j = 0; j < sizeof(shape_data[i]); ++j)
+        shape_data[i][j] = IO_random() & IO_random() & IO_random();
+      shape[i].width  = IO_random() % 16 + 1;
+      shape[i].height = IO_random() % max_height + 1;
+      shape[i].bpp    = 1;
+      shape[i].data   = shape_data[i];
+      obj[i].x        = IO_random() % 16;
+      obj[i].y        = i ? min_y1 + IO_random() % 16 : IO_random() % max_y0;
+      obj[i].width    = shape[i].width;
+      obj[i].height   = shape[i].height;
+      obj[i].shape    = &shape[i];
+    }
+    if(t % 8 == 0)
+      obj[0].shape = 0;
+
+    uint16_t x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    int hit1 = SI_collision_pixel(&obj[0], &obj[1], &x1, &y1);
+    int hit2 = collision_pixel_naive(&obj[0], &obj[1], &x2, &y2);
+    if(hit1 != hit2 || x1 != x2 || y1 != y2)
+      ++failed;
+  }
+  return failed;
+}
+
+//------------------------------------------------------------------------------
+// Scatter the objects over the screen; a quarter are "missiles" hitting
+// everything else, the rest are "targets" not interested in each other
+//------------------------------------------------------------------------------
+static void setup(uint8_t num)
+{
+  memset(objects, 0, sizeof(objects));
+  for(int i = 0; i < num; ++i) {
+    objects[i].x      = IO_random() % 80;
+    objects[i].y      = IO_random() % 44;
+    objects[i].width  = IO_random() % 6 + 3;
+    objects[i].height = IO_random() % 6 + 3;
+    objects[i].flags  = SI_OBJECT_VISIBLE;
+    objects[i].layer  = i % 4 ? 0x01 : 0x02;
+    objects[i].mask   = i % 4 ? 0x00 : 0x01;
+    object_ptrs[i]    = &objects[i];
+  }
+  memset(&scene, 0, sizeof(scene));
+  scene.objects     = object_ptrs;
+  scene.num_objects = num;
+  scene.collision   = collision;
+}
+
+//------------------------------------------------------------------------------
+// Jiggle the objects a bit
+//------------------------------------------------------------------------------
+static void move(uint8_t num)
+{
+  for(int i = 0; i < num; ++i) {
+    uint32_t r = IO_random();
+    if((r & 0x3) == 0 && objects[i].x > 0)
+      --objects[i].x;
+    else if((r & 0x3) == 1 && objects[i].x < 80)
+      ++objects[i].x;
+    if((r & 0xc) == 0 && objects[i].y > 0)
+      --objects[i].y;
+    else if((r & 0xc) == 4 && objects[i].y < 44)
+      ++objects[i].y;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_io uart0;
+  IO_uart_init(&uart0, 0, 0, 115200);
+
+  //----------------------------------------------------------------------------
+  // Short shapes, shapes taller than 32 rows, and tall shapes overlapping
+  // only below their 32nd row
+  //----------------------------------------------------------------------------
+  uint32_t failed = test_pixel(32, 16, 0);
+  IO_print(&uart0, "Pixel collisions: %s (%u mismatches)\r\n",
+           failed ? "FAILED" : "OK", failed);
+  failed = test_pixel(48, 16, 0);
+  IO_print(&uart0, "Tall pixel collisions: %s (%u mismatches)\r\n",
+           failed ? "FAILED" : "OK", failed);
+  failed = test_pixel(48, 4, 36);
+  IO_print(&uart0, "Low pixel collisions: %s (%u mismatches)\r\n",
+           failed ? "FAILED" : "OK", failed);
+
+  uint8_t sizes[] = {19, 64, 128, 255};
+  for(int s = 0; s < sizeof(sizes); ++s) {
+    uint8_t num = sizes[s];
+
+    //--------------------------------------------------------------------------
+    // Both methods need to find the same pairs
+    //--------------------------------------------------------------------------
+    failed = 0;
+    setup(num);
+    for(int f = 0; f < FRAMES; ++f) {
+      num_pairs = checksum = 0;
+      collision_naive(&scene);
+      uint32_t naive_pairs = num_pairs, naive_checksum = checksum;
+      num_pairs = checksum = 0;
+      SI_collision_detect(&scene);
+      if(num_pairs != naive_pairs || checksum != naive_checksum)
+        ++failed;
+      move(num);
+    }
+
+    //--------------------------------------------------------------------------
+    // Time them separately over the same motion
+    //--------------------------------------------------------------------------
+    IO_rng_seed(s);
+    setup(num);
+    uint64_t start = IO_time();
+    for(int f = 0; f < FRAMES; ++f) {
+      collision_naive(&scene);
+      move(num);
+    }
+    uint64_t naive_time = IO_time() - start;
+
+    IO_rng_seed(s);
+    setup(num);
+    start = IO_time();
+    for(int f = 0; f < FRAMES; ++f) {
+      SI_collision_detect(&scene);
+      move(num);
+    }
+    uint64_t sweep_time = IO_time() - start;
+
+    IO_print(&uart0, "%u objects: %s, %u frames: naive %llu ms, "
+             "sweep %llu ms\r\n", num, failed ? "FAILED" : "OK", FRAMES,
+             naive_time, sweep_time);
+  }
+
+  while(1)
+    IO_wait_for_interrupt();
+}
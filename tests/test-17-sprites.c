@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <drivers/pcd8544/pcd8544.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Off-screen pixel matrices; the devices are never initialized, we only use
+// the drawing functions
+//------------------------------------------------------------------------------
+static pcd8544 ref;
+static pcd8544 fast;
+
+#define ROUNDS 10000
+
+extern const IO_bitmap DefenderImg;
+extern const IO_bitmap Invader1Img;
+
+//------------------------------------------------------------------------------
+// Draw through the compiled routine
+//------------------------------------------------------------------------------
+static void draw_compiled(pcd8544 *device, uint16_t x, uint16_t y,
+  const IO_bitmap *bmp)
+{
+  IO_framebuffer fb;
+  PCD8544_get_framebuffer(device, &fb);
+  bmp->draw[y % 8](fb.pixels + (y / 8) * fb.stride + x, fb.stride);
+  PCD8544_mark_dirty(device, x, y, bmp->width, bmp->height);
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_io uart0;
+  IO_uart_init(&uart0, 0, 0, 115200);
+
+  const IO_bitmap *sprites[] = {&DefenderImg, &Invader1Img};
+  const char      *names[]   = {"Defender", "Invader1"};
+
+  for(int s = 0; s < 2; ++s) {
+    const IO_bitmap *bmp = sprites[s];
+
+    //--------------------------------------------------------------------------
+    // The compiled routines need to produce exactly what the generic blitter
+    // does, at every position, over a dirty background
+    //--------------------------------------------------------------------------
+    uint32_t failed = 0;
+    for(uint16_t y = 0; y + bmp->height <= 48; ++y)
+      for(uint16_t x = 0; x + bmp->width <= 84; x += 3) {
+        memset(ref.pixels, 0xa5, sizeof(ref.pixels));
+        memset(fast.pixels, 0xa5, sizeof(fast.pixels));
+        PCD8544_blit(&ref, x, y, bmp->width, bmp->height, bmp->data);
+        draw_compiled(&fast, x, y, bmp);
+        if(memcmp(ref.pixels, fast.pixels, sizeof(ref.pixels)))
+          ++failed;
+      }
+
+    //--------------------------------------------------------------------------
+    // Time them over all the vertical offsets
+    //--------------------------------------------------------------------------
+    uint64_t start = IO_time();
+    for(int i = 0; i < ROUNDS; ++i)
+      PCD8544_blit(&ref, i % 64, i % 40, bmp->width, bmp->height, bmp->data);
+    uint64_t generic_time = IO_time() - start;
+
+    start = IO_time();
+    for(int i = 0; i < ROUNDS; ++i)
+      draw_compiled(&fast, i % 64, i % 40, bmp);
+    uint64_t compiled_time = IO_time() - start;
+
+    IO_print(&uart0, "%s: %s (%u mismatches), %u draws: generic %llu ms, "
+             "compiled %llu ms\r\n", names[s], failed ? "FAILED" : "OK",
+             failed, ROUNDS, generic_time, compiled_time);
+  }
+
+  while(1)
+    IO_wait_for_interrupt();
+}
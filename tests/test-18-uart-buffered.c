@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <io/IO_profiler.h>
+
+//------------------------------------------------------------------------------
+// Devices and state
+//------------------------------------------------------------------------------
+IO_io uart0;
+volatile uint32_t counter;
+
+//------------------------------------------------------------------------------
+// Echo whatever comes in; the reads sleep until there is data, so the
+// counter keeps going in the meantime. Every line ends with a report of how
+// long queuing a full line of output took.
+//------------------------------------------------------------------------------
+void echo()
+{
+  while(1) {
+    char c;
+    IO_read(&uart0, &c, 1);
+    IO_write(&uart0, &c, 1);
+    if(c != '\r')
+      continue;
+
+    uint32_t start = IO_profiler_cycles();
+    IO_print(&uart0, "\n0123456789012345678901234567890123456789\r\n");
+    uint32_t cycles = IO_profiler_cycles() - start;
+    IO_print(&uart0, "Queuing a line took %lu cycles, counter: %lu\r\n",
+             cycles, counter);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Keep the CPU busy
+//------------------------------------------------------------------------------
+void count()
+{
+  while(1)
+    ++counter;
+}
+
+IO_sys_thread tcb[2];
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(0);
+  IO_uart_init_buffered(&uart0, 0, 0, 115200, 256, 16);
+
+  IO_sys_thread_add(&tcb[0], echo,  1000, 255);
+  IO_sys_thread_add(&tcb[1], count,  500, 255);
+
+  IO_sys_run(1000);
+}
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <tm4c/TM4C_dma.h>
+
+//------------------------------------------------------------------------------
+// Buffers; the sources are longer than a single task can handle
+//------------------------------------------------------------------------------
+#define COPY_SIZE 3000
+#define SW_CHANNEL 30
+#define UART0_TX_CHANNEL 9
+#define UART0_DR ((void *)0x4000c000)
+
+uint8_t src[COPY_SIZE];
+uint8_t dst[COPY_SIZE];
+char line[2048];
+dma_control tasks[3];
+volatile uint8_t done;
+volatile uint8_t chunks_done;
+
+//------------------------------------------------------------------------------
+// Completion callback of the memory copy
+//------------------------------------------------------------------------------
+void copy_done(uint8_t channel, uint8_t type, void *arg)
+{
+  (void)channel; (void)type; (void)arg;
+  done = 1;
+}
+
+//------------------------------------------------------------------------------
+// Completion callback of the queued UART chunks
+//------------------------------------------------------------------------------
+void chunk_done(uint8_t channel, uint8_t type, void *arg)
+{
+  (void)channel; (void)type;
+  chunks_done |= (1 << (uint32_t)arg);
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_io uart0;
+  IO_uart_init(&uart0, 0, IO_DMA, 115200);
+
+  //----------------------------------------------------------------------------
+  // Scatter-gather memory copy in three uneven tasks
+  //----------------------------------------------------------------------------
+  for(int i = 0; i < COPY_SIZE; ++i)
+    src[i] = i;
+
+  TM4C_dma_channel_alloc(SW_CHANNEL, 0, copy_done, 0);
+  uint32_t control = (0x03 << 14); // arbitrate every 8 bytes
+  TM4C_dma_set_task(&tasks[0], src,      dst,      control, 0, 1000);
+  TM4C_dma_set_task(&tasks[1], src+1000, dst+1000, control, 0, 1024);
+  TM4C_dma_set_task(&tasks[2], src+2024, dst+2024, control, 0, 976);
+  TM4C_dma_scatter_gather(SW_CHANNEL, 0, tasks, 3, 0);
+  while(!done)
+    IO_wait_for_interrupt();
+
+  int errors = 0;
+  for(int i = 0; i < COPY_SIZE; ++i)
+    if(dst[i] != src[i])
+      ++errors;
+  IO_print(&uart0, "Scatter-gather copy of %d bytes, %d errors\r\n",
+           COPY_SIZE, errors);
+
+  //----------------------------------------------------------------------------
+  // A UART write longer than a single task
+  //----------------------------------------------------------------------------
+  for(int i = 0; i < 2048; ++i)
+    line[i] = (i % 64 == 63) ? '\n' : 'a' + (i % 64) % 26;
+  int32_t written = IO_write(&uart0, line, 2048);
+  IO_sync(&uart0);
+  IO_print(&uart0, "\r\nQueued %ld bytes in one DMA write\r\n", written);
+
+  //----------------------------------------------------------------------------
+  // Keep the channel saturated with chunks queued behind each other
+  //----------------------------------------------------------------------------
+  uint32_t chunk = 2048/DMA_MAX_IN_FLIGHT;
+  uint8_t in_flight = 0;
+  for(uint32_t i = 0; i < DMA_MAX_IN_FLIGHT; ++i) {
+    TM4C_dma_submit(UART0_TX_CHANNEL, 0, line+i*chunk, UART0_DR,
+                    (0x03 << 30) | (0x03 << 14), chunk, chunk_done, (void *)i);
+    in_flight = TM4C_dma_in_flight(UART0_TX_CHANNEL);
+  }
+  int32_t full = TM4C_dma_submit(UART0_TX_CHANNEL, 0, line, UART0_DR, 0, 1,
+                                 0, 0);
+  IO_sync(&uart0);
+  IO_print(&uart0, "\r\n%d in flight, overflow: %d, done mask: 0x%x, "
+           "in flight after sync: %d\r\n", in_flight, full, chunks_done,
+           TM4C_dma_in_flight(UART0_TX_CHANNEL));
+
+  while(1)
+    IO_wait_for_interrupt();
+}
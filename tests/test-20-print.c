@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <io/IO_profiler.h>
+
+//------------------------------------------------------------------------------
+// A device counting the writes and dropping the data
+//------------------------------------------------------------------------------
+uint32_t num_calls;
+uint32_t num_bytes;
+
+int32_t count_write(IO_io *io, const void *data, uint32_t length)
+{
+  ++num_calls;
+  num_bytes += length;
+  return length;
+}
+
+const IO_ops counter_ops = { count_write, 0, 0, 0, 0, 0 };
+IO_io counter;
+IO_io uart0;
+
+//------------------------------------------------------------------------------
+// Format a typical line of the profiler output
+//------------------------------------------------------------------------------
+int32_t print_line(IO_io *io, uint32_t i)
+{
+  return IO_print(io, "Frame %5lu: update %4lu us, draw %4lu us, %08x %.3f\r\n",
+                  i, 123+i%7, 4567-i%13, 0xbeefu, 29.97);
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(0);
+  IO_uart_init(&uart0, 0, 0, 115200);
+  counter.ops = &counter_ops;
+
+  //----------------------------------------------------------------------------
+  // Formatting
+  //----------------------------------------------------------------------------
+  IO_print(&uart0, "[%5u] [%-5u] [%08x] [%05d] [%.3f] [%c] [%.2s] [100%%]\r\n",
+           42, 42, 0xbeef, -42, 3.14159, 'x', "abc");
+  IO_print(&uart0, "expected:\r\n");
+  IO_print(&uart0, "[   42] [42   ] [0000beef] [-0042] [3.142] [x] [ab] "
+           "[100%%]\r\n");
+
+  //----------------------------------------------------------------------------
+  // Formatting to memory, with truncation
+  //----------------------------------------------------------------------------
+  char str[8];
+  int32_t len = IO_snprintf(str, sizeof(str), "%lu:%s", 123456ul, "abc");
+  IO_print(&uart0, "snprintf: %ld [%s], expected: 10 [123456:]\r\n", len, str);
+
+  //----------------------------------------------------------------------------
+  // Calls, bytes and cycles per formatted line
+  //----------------------------------------------------------------------------
+  uint32_t cycles = 0;
+  int32_t  ret    = 0;
+  for(uint32_t i = 0; i < 100; ++i) {
+    uint32_t start = IO_profiler_cycles();
+    ret += print_line(&counter, i);
+    cycles += IO_profiler_cycles() - start;
+  }
+
+  IO_print(&uart0, "Per line: %lu writes, %lu bytes (returned %ld), "
+           "%lu cycles\r\n", num_calls/100, num_bytes/100, ret/100,
+           cycles/100);
+
+  //----------------------------------------------------------------------------
+  // Cycles per number conversion
+  //----------------------------------------------------------------------------
+  static const uint64_t values[] = {
+    7, 1234, 4294967295ULL, 1234567890123ULL, 18446744073709551615ULL};
+  for(uint32_t i = 0; i < sizeof(values)/sizeof(values[0]); ++i) {
+    uint32_t dec = IO_profiler_cycles();
+    IO_snprintf(str, sizeof(str), "%llu", values[i]);
+    dec = IO_profiler_cycles() - dec;
+    uint32_t hex = IO_profiler_cycles();
+    IO_snprintf(str, sizeof(str), "%llx", values[i]);
+    hex = IO_profiler_cycles() - hex;
+    IO_print(&uart0, "%20llu: %4lu cycles decimal, %4lu cycles hex\r\n",
+             values[i], dec, hex);
+  }
+
+  cycles = IO_profiler_cycles();
+  print_line(&uart0, 0);
+  cycles = IO_profiler_cycles() - cycles;
+  IO_print(&uart0, "The same line to UART took %lu cycles\r\n", cycles);
+
+  while(1)
+    IO_wait_for_interrupt();
+}
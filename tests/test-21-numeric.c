@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <io/IO_error.h>
+#include <io/IO_profiler.h>
+
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// A device reading from a string, to feed IO_scan
+//------------------------------------------------------------------------------
+const char *source;
+
+int32_t source_read(IO_io *io, void *data, uint32_t length)
+{
+  uint32_t i;
+  for(i = 0; i < length && *source; ++i)
+    ((char *)data)[i] = *source++;
+  if(i == 0)
+    return -IO_EIO;
+  return i;
+}
+
+const IO_ops source_ops = { 0, 0, source_read, 0, 0, 0 };
+IO_io input;
+IO_io uart0;
+uint32_t failures;
+
+//------------------------------------------------------------------------------
+// Compare the formatted output with the expected one
+//------------------------------------------------------------------------------
+void check(const char *result, const char *expected)
+{
+  if(!strcmp(result, expected))
+    return;
+  ++failures;
+  IO_print(&uart0, "FAILED: got %s, expected %s\r\n", result, expected);
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(0);
+  IO_uart_init(&uart0, 0, 0, 115200);
+  input.ops = &source_ops;
+
+  //----------------------------------------------------------------------------
+  // Formatting
+  //----------------------------------------------------------------------------
+  char str[32];
+  IO_snprintf(str, sizeof(str), "%f", 3.14159265f);
+  check(str, "3.141593");
+  IO_snprintf(str, sizeof(str), "%f", 0.0024347f);
+  check(str, "0.0024347");
+  IO_snprintf(str, sizeof(str), "%f", -2.5e20f);
+  check(str, "-2.5e20");
+  IO_snprintf(str, sizeof(str), "%f", 29.97f);
+  check(str, "29.97");
+  IO_snprintf(str, sizeof(str), "%f", 3.4e38f);
+  check(str, "3.4e38");
+  IO_snprintf(str, sizeof(str), "%.3f", 29.97f);
+  check(str, "29.970");
+  IO_snprintf(str, sizeof(str), "%lf", 3.14159265);
+  check(str, "3.14159265");
+  IO_snprintf(str, sizeof(str), "%k", (IO_q16)(3*IO_Q16_ONE/2));
+  check(str, "1.50000");
+  IO_snprintf(str, sizeof(str), "%.2k", (IO_q16)-205887);
+  check(str, "-3.14");
+
+  //----------------------------------------------------------------------------
+  // Parsing
+  //----------------------------------------------------------------------------
+  float  f;
+  double d;
+  IO_q16 q;
+  source = "3.14159 -2.5e20 1234.5678e-3 -1.5 0.00001 ";
+  IO_scan(&input, IO_FLOAT, &f, 0);
+  IO_snprintf(str, sizeof(str), "%f", f);
+  check(str, "3.14159");
+  IO_scan(&input, IO_FLOAT, &f, 0);
+  IO_snprintf(str, sizeof(str), "%f", f);
+  check(str, "-2.5e20");
+  IO_scan(&input, IO_DOUBLE, &d, 0);
+  IO_snprintf(str, sizeof(str), "%lf", d);
+  check(str, "1.2345678");
+  IO_scan(&input, IO_Q16, &q, 0);
+  IO_snprintf(str, sizeof(str), "%d", (int)q);
+  check(str, "-98304");
+  IO_scan(&input, IO_Q16, &q, 0);
+  IO_snprintf(str, sizeof(str), "%d", (int)q);
+  check(str, "1");
+
+  IO_print(&uart0, "Accuracy checks done, %lu failures\r\n", failures);
+
+  //----------------------------------------------------------------------------
+  // Cycles per conversion
+  //----------------------------------------------------------------------------
+  uint32_t c_float = IO_profiler_cycles();
+  IO_snprintf(str, sizeof(str), "%f", 123.456f);
+  c_float = IO_profiler_cycles() - c_float;
+
+  uint32_t c_double = IO_profiler_cycles();
+  IO_snprintf(str, sizeof(str), "%lf", 123.456);
+  c_double = IO_profiler_cycles() - c_double;
+
+  uint32_t c_q16 = IO_profiler_cycles();
+  IO_snprintf(str, sizeof(str), "%k", (IO_q16)8090812);
+  c_q16 = IO_profiler_cycles() - c_q16;
+
+  IO_print(&uart0, "Formatting: %lu cycles float, %lu double, %lu Q16.16\r\n",
+           c_float, c_double, c_q16);
+
+  source = "123.456 123.456 123.456 ";
+  c_float = IO_profiler_cycles();
+  IO_scan(&input, IO_FLOAT, &f, 0);
+  c_float = IO_profiler_cycles() - c_float;
+
+  c_double = IO_profiler_cycles();
+  IO_scan(&input, IO_DOUBLE, &d, 0);
+  c_double = IO_profiler_cycles() - c_double;
+
+  c_q16 = IO_profiler_cycles();
+  IO_scan(&input, IO_Q16, &q, 0);
+  c_q16 = IO_profiler_cycles() - c_q16;
+
+  IO_print(&uart0, "Parsing: %lu cycles float, %lu double, %lu Q16.16\r\n",
+           c_float, c_double, c_q16);
+
+  while(1)
+    IO_wait_for_interrupt();
+}
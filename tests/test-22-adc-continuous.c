@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <io/IO_display.h>
+
+IO_io display;
+IO_io adc;
+volatile uint32_t halves;
+
+//------------------------------------------------------------------------------
+// Half of the ring has been filled
+//------------------------------------------------------------------------------
+void adc_event(IO_io *io, uint16_t event)
+{
+  ++halves;
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_display_init(&display, 0);
+
+  //----------------------------------------------------------------------------
+  // The slider pin twice in one sequence, 1kHz, 16 conversions averaged in
+  // hardware, 50 sequences per half of the ring
+  //----------------------------------------------------------------------------
+  IO_adc_attrs attrs;
+  attrs.inputs[0]  = 0;
+  attrs.inputs[1]  = 0;
+  attrs.num_inputs = 2;
+  attrs.oversample = 4;
+  attrs.timer      = 0;
+  attrs.depth      = 50;
+  attrs.period     = 1000000;
+  int32_t ret = IO_adc_init_continuous(&adc, 1, 0, &attrs);
+  adc.event = adc_event;
+
+  //----------------------------------------------------------------------------
+  // Ten halves per second are expected, the values are read without waiting
+  //----------------------------------------------------------------------------
+  uint64_t start = IO_time();
+  while(1) {
+    uint64_t val[2];
+    IO_read(&adc, val, 2);
+    uint64_t elapsed = IO_time() - start;
+    IO_display_clear(&display);
+    IO_print(&display, "Init: %ld\r\n", ret);
+    IO_print(&display, "ADC: %llu\r\n", val[0]);
+    IO_print(&display, "     %llu\r\n", val[1]);
+    IO_print(&display, "Halves: %lu\r\n", halves);
+    IO_print(&display, "Time: %llums\r\n", elapsed);
+    IO_sync(&display);
+
+    uint64_t next = IO_time() + 100;
+    while(IO_time() < next)
+      IO_wait_for_interrupt();
+  }
+}
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2016 by Lukasz Janyst <lukasz@jany.st>
+//------------------------------------------------------------------------------
+// This file is part of silly-invaders.
+//
+// silly-invaders is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// silly-invaders is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <io/IO.h>
+#include <io/IO_sys.h>
+#include <io/IO_device.h>
+#include <io/IO_display.h>
+#include <io/IO_swtimer.h>
+
+#define NUM_TIMERS 200
+
+IO_io display;
+IO_io led;
+IO_swtimer blink;
+IO_swtimer timers[NUM_TIMERS];
+volatile uint32_t expired;
+volatile uint64_t late_max;
+uint8_t state = 0;
+
+//------------------------------------------------------------------------------
+// Toggle the LED
+//------------------------------------------------------------------------------
+void blink_event(IO_swtimer *timer)
+{
+  state = !state;
+  IO_set(&led, state);
+}
+
+//------------------------------------------------------------------------------
+// A one-shot timer expired, restart it with a different time-out
+//------------------------------------------------------------------------------
+void timer_event(IO_swtimer *timer)
+{
+  uint64_t late = IO_time_ns() - timer->deadline;
+  if(late > late_max)
+    late_max = late;
+  ++expired;
+
+  uint32_t index = timer - timers;
+  IO_swtimer_start(timer, (index % 17 + 1) * 3000000, 0);
+}
+
+//------------------------------------------------------------------------------
+// Start the show
+//------------------------------------------------------------------------------
+int main()
+{
+  IO_init(4096);
+  IO_display_init(&display, 0);
+  IO_gpio_init(&led, 41, 0, 1);
+
+  IO_swtimer_init(&blink, blink_event, 0);
+  IO_swtimer_start(&blink, 500000000, 500000000);
+
+  for(int i = 0; i < NUM_TIMERS; ++i) {
+    IO_swtimer_init(&timers[i], timer_event, 0);
+    IO_swtimer_start(&timers[i], (i + 1) * 1000000, 0);
+  }
+
+  //----------------------------------------------------------------------------
+  // About 200 * 1000 / 27 expiries per second are expected
+  //----------------------------------------------------------------------------
+  uint64_t start = IO_time();
+  while(1) {
+    uint64_t elapsed = IO_time() - start;
+    IO_display_clear(&display);
+    IO_print(&display, "Timers: %u\r\n", IO_swtimer_count());
+    IO_print(&display, "Expired: %lu\r\n", expired);
+    IO_print(&display, "Late: %lluns\r\n", late_max);
+    IO_print(&display, "Time: %llums\r\n", elapsed);
+    IO_sync(&display);
+
+    uint64_t next = IO_time() + 100;
+    while(IO_time() < next)
+      IO_wait_for_interrupt();
+  }
+}
@@ -23,8 +23,11 @@
 #include <io/IO_error.h>
 #include <io/IO_malloc_low.h>
 #include <io/IO_sys_low.h>
+#include <io/IO_swtimer.h>
+#include <io/IO_swtimer_low.h>
+#include <io/IO_profiler.h>
+#include <io/IO_utils.h>
 #include "TM4C.h"
-#include "TM4C_events.h"
 #include "TM4C_gpio.h"
 #include "TM4C_dma.h"
 #include "TM4C_timer.h"
@@ -115,15 +118,49 @@ void TM4C_pll_init()
 }
 
 //------------------------------------------------------------------------------
-// Count time in miliseconds
+// The monotonic clock is a wide timer counting the system clock cycles; it
+// keeps running while the core sleeps, unlike the DWT cycle counter
 //------------------------------------------------------------------------------
-static IO_io tick_timer;
-static uint64_t time = 0;
-static void tick_event(IO_io *io, uint16_t event)
+#define CLOCK_TIMER   9
+#define CYCLES_PER_MS 80000
+
+//------------------------------------------------------------------------------
+// The software timers run on a one-shot wide timer programmed for the nearest
+// deadline; the deadlines closer than SWTIMER_MIN_NS are rounded up so that
+// the interrupt is not missed
+//------------------------------------------------------------------------------
+#define SWTIMER_TIMER  11
+#define SWTIMER_MIN_NS 1000
+
+static IO_io swtimer_hw;
+static void swtimer_event(IO_io *io, uint16_t event)
+{
+  IO_swtimer_expire();
+}
+
+void IO_swtimer_arm(uint64_t deadline)
+{
+  if(!deadline) {
+    IO_set(&swtimer_hw, 0);
+    return;
+  }
+
+  uint64_t now = IO_time_ns();
+  uint64_t timeout = deadline > now ? deadline - now : 0;
+  if(timeout < SWTIMER_MIN_NS)
+    timeout = SWTIMER_MIN_NS;
+  IO_set(&swtimer_hw, timeout);
+}
+
+//------------------------------------------------------------------------------
+// The milisecond tick; being periodic, it expires at the milisecond
+// boundaries of the clock regardless of the latency of the handler
+//------------------------------------------------------------------------------
+static IO_swtimer tick_timer;
+static void tick_event(IO_swtimer *timer)
 {
-  ++time;
-  IO_sys_timer_tick(time);
-  IO_set(&tick_timer, 1000000); // fire in a milisecond
+  TM4C_gpio_debounce_tick();
+  IO_sys_timer_tick(IO_time());
 }
 
 //------------------------------------------------------------------------------
@@ -141,46 +178,18 @@ int32_t TM4C_init(uint32_t stack_size)
     "dsb\r\n"        // force memory writed before continuing
     "isb\r\n" );     // reset the pipeline
 
-  TM4C_timer_init(&tick_timer, 11);
-  tick_timer.event = tick_event;
-  tick_event(0, 0);
-  return 0;
-}
+  // Enable the DWT cycle counter
+  DEMCR_REG     |= 0x01000000;
+  DWTCYCCNT_REG  = 0;
+  DWTCTRL_REG   |= 0x01;
 
-//------------------------------------------------------------------------------
-// Enable events on IO device
-//------------------------------------------------------------------------------
-int32_t IO_event_enable(IO_io *io, uint16_t events)
-{
-  switch(io->type) {
-    case IO_UART:
-      return TM4C_uart_event_enable(io, events);
-    case IO_SSI:
-      return TM4C_ssi_event_enable(io, events);
-    case IO_GPIO:
-      return TM4C_gpio_event_enable(io, events);
-    case IO_ADC:
-      return TM4C_adc_event_enable(io, events);
-  }
-  return -IO_ENOSYS;
-}
+  TM4C_timer_counter_init(CLOCK_TIMER);
+  TM4C_timer_init(&swtimer_hw, SWTIMER_TIMER);
+  swtimer_hw.event = swtimer_event;
 
-//------------------------------------------------------------------------------
-// Disable events on IO device
-//------------------------------------------------------------------------------
-int32_t IO_event_disable(IO_io *io, uint16_t events)
-{
-  switch(io->type) {
-    case IO_UART:
-      return TM4C_uart_event_disable(io, events);
-    case IO_SSI:
-      return TM4C_ssi_event_disable(io, events);
-    case IO_GPIO:
-      return TM4C_gpio_event_disable(io, events);
-    case IO_ADC:
-      return TM4C_adc_event_disable(io, events);
-  }
-  return -IO_ENOSYS;
+  IO_swtimer_init(&tick_timer, tick_event, 0);
+  IO_swtimer_start(&tick_timer, 1000000, 1000000);
+  return 0;
 }
 
 //------------------------------------------------------------------------------
@@ -199,9 +208,68 @@ void TM4C_enable_interrupt(uint8_t number, uint8_t priority)
 }
 
 //------------------------------------------------------------------------------
-// Get time
+// Device registry
+//------------------------------------------------------------------------------
+static IO_io *devices[TM4C_DEV_MAX];
+
+void TM4C_device_register(uint8_t slot, IO_io *io)
+{
+  devices[slot] = io;
+}
+
+IO_io *TM4C_device(uint8_t slot)
+{
+  return devices[slot];
+}
+
+//------------------------------------------------------------------------------
+// Pass the events to the callback of the device
+//------------------------------------------------------------------------------
+void TM4C_device_dispatch(uint8_t slot, uint16_t events)
+{
+  IO_io *io = devices[slot];
+  if(io && io->event)
+    io->event(io, events);
+}
+
+//------------------------------------------------------------------------------
+// Get time; divides by CYCLES_PER_MS = 2^7 * 625 with a reciprocal instead of
+// a 64-bit division, which is a library call on the Cortex-M4. The result is
+// exact for all the cycle counts below 2^64.
 //------------------------------------------------------------------------------
 uint64_t IO_time()
 {
-  return time;
+  return mulhi64(IO_time_cycles() >> 7, 0xd1b71758e219652cULL) >> 9;
+}
+
+//------------------------------------------------------------------------------
+// Get time in nanoseconds
+//------------------------------------------------------------------------------
+uint64_t IO_time_ns()
+{
+  return (IO_time_cycles() * 25) >> 1;
+}
+
+//------------------------------------------------------------------------------
+// Get time in clock cycles
+//------------------------------------------------------------------------------
+uint64_t IO_time_cycles()
+{
+  return TM4C_timer_counter_read(CLOCK_TIMER);
+}
+
+//------------------------------------------------------------------------------
+// Get the value of the cycle counter
+//------------------------------------------------------------------------------
+uint32_t IO_profiler_cycles()
+{
+  return DWTCYCCNT_REG;
+}
+
+//------------------------------------------------------------------------------
+// Get the number of cycles per second
+//------------------------------------------------------------------------------
+uint32_t IO_profiler_frequency()
+{
+  return 80000000;
 }
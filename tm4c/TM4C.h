@@ -40,6 +40,9 @@
 #define MPUCTRL_REG          (*(volatile unsigned long *)0xe000ed94)
 #define MPUBASE_REG          (*(volatile unsigned long *)0xe000ed9c)
 #define MPUATTR_REG          (*(volatile unsigned long *)0xe000eda0)
+#define DEMCR_REG            (*(volatile unsigned long *)0xe000edfc)
+#define DWTCTRL_REG          (*(volatile unsigned long *)0xe0001000)
+#define DWTCYCCNT_REG        (*(volatile unsigned long *)0xe0001004)
 
 #define RIS_REG              (*(volatile unsigned long *)0x400fe050)
 #define RCC_REG              (*(volatile unsigned long *)0x400fe060)
@@ -58,11 +61,13 @@
 //------------------------------------------------------------------------------
 #define DMACFG_REG           (*(volatile unsigned long *)0x400ff004)
 #define DMACTLBASE_REG       (*(volatile unsigned long *)0x400ff008)
+#define DMASWREQ_REG         (*(volatile unsigned long *)0x400ff014)
 #define DMAUSEBURSTSET_REG   (*(volatile unsigned long *)0x400ff018)
 #define DMAUSEBURSTCLR_REG   (*(volatile unsigned long *)0x400ff01c)
 #define DMAREQMASKSET_REG    (*(volatile unsigned long *)0x400ff020)
 #define DMAREQMASKCLR_REG    (*(volatile unsigned long *)0x400ff024)
 #define DMAENASET_REG        (*(volatile unsigned long *)0x400ff028)
+#define DMAENACLR_REG        (*(volatile unsigned long *)0x400ff02c)
 #define DMAALTSET_REG        (*(volatile unsigned long *)0x400ff030)
 #define DMAALTCLR_REG        (*(volatile unsigned long *)0x400ff034)
 #define DMAPRIOSET_REG       (*(volatile unsigned long *)0x400ff038)
@@ -167,6 +172,7 @@
 #define SSI_CPSR          0x0010
 #define SSI_IM            0x0014
 #define SSI_MIS           0x001c
+#define SSI_ICR           0x0020
 #define SSI_DMACTL        0x0024
 #define SSI_CC            0x0fc8
 
@@ -184,6 +190,8 @@
 #define GPTM_ICR           0x0024
 #define GPTM_TAILR         0x0028
 #define GPTM_TBILR         0x002c
+#define GPTM_TAV           0x0050
+#define GPTM_TBV           0x0054
 
 #define GPTM_MODULE_OFFSET 0x1000
 
@@ -198,7 +206,9 @@
 #define ADC_RIS           0x0004
 #define ADC_IM            0x0008
 #define ADC_ISC           0x000c
+#define ADC_EMUX          0x0014
 #define ADC_PSSI          0x0028
+#define ADC_SAC           0x0030
 #define ADC_SSMUX0        0x0040
 #define ADC_SSCTL0        0x0044
 #define ADC_SSFIFO0       0x0048
@@ -224,3 +234,33 @@ int32_t TM4C_init(uint32_t stack_size);
 //! Enable an interrupt
 //------------------------------------------------------------------------------
 void TM4C_enable_interrupt(uint8_t number, uint8_t priority);
+
+//------------------------------------------------------------------------------
+//! Device registry; every driver owns a range of slots indexed by the module
+//! or pin number, so that the interrupt handlers find the devices in one
+//! lookup
+//------------------------------------------------------------------------------
+#define TM4C_DEV_UART  0  // 8 modules
+#define TM4C_DEV_SSI   8  // 4 modules
+#define TM4C_DEV_GPIO  12 // 45 pins
+#define TM4C_DEV_TIMER 57 // 12 modules
+#define TM4C_DEV_ADC   69 // 8 sample sequencers
+#define TM4C_DEV_MAX   77
+
+struct IO_io;
+
+//------------------------------------------------------------------------------
+//! Register a device in the slot
+//------------------------------------------------------------------------------
+void TM4C_device_register(uint8_t slot, struct IO_io *io);
+
+//------------------------------------------------------------------------------
+//! Get the device registered in the slot, 0 if none
+//------------------------------------------------------------------------------
+struct IO_io *TM4C_device(uint8_t slot);
+
+//------------------------------------------------------------------------------
+//! Pass the events to the callback of the device registered in the slot, if
+//! there is one
+//------------------------------------------------------------------------------
+void TM4C_device_dispatch(uint8_t slot, uint16_t events);
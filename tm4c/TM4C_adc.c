@@ -18,9 +18,16 @@
 //------------------------------------------------------------------------------
 
 #include <io/IO.h>
+#include <io/IO_device.h>
 #include <io/IO_error.h>
+#include <io/IO_sys.h>
+#include <io/IO_malloc.h>
 #include "TM4C.h"
+#include "TM4C_dma.h"
 #include "TM4C_gpio.h"
+#include "TM4C_timer.h"
+
+#include <string.h>
 
 //------------------------------------------------------------------------------
 // Helpers
@@ -44,20 +51,47 @@ struct adc_data {
   uint16_t ctl;
   uint16_t fifo;
   uint8_t  interrupt;
+  uint8_t  dma_channel;
+  uint8_t  fifo_depth;
 };
 
+//------------------------------------------------------------------------------
+// Indexed by the sequencer number for everything but the GPIO, which is
+// indexed by the analog input number
+//------------------------------------------------------------------------------
 static const struct adc_data adc_info[] = {
-  {GPIO_PORTE_NUM, GPIO_PIN3_NUM, ADC_SSMUX0, ADC_SSCTL0, ADC_SSFIFO0, 14},
-  {GPIO_PORTE_NUM, GPIO_PIN2_NUM, ADC_SSMUX1, ADC_SSCTL1, ADC_SSFIFO1, 15},
-  {GPIO_PORTE_NUM, GPIO_PIN1_NUM, ADC_SSMUX2, ADC_SSCTL2, ADC_SSFIFO2, 16},
-  {GPIO_PORTE_NUM, GPIO_PIN0_NUM, ADC_SSMUX3, ADC_SSCTL3, ADC_SSFIFO3, 17},
-  {GPIO_PORTD_NUM, GPIO_PIN3_NUM, ADC_SSMUX0, ADC_SSCTL0, ADC_SSFIFO0, 48},
-  {GPIO_PORTD_NUM, GPIO_PIN2_NUM, ADC_SSMUX1, ADC_SSCTL1, ADC_SSFIFO1, 49},
-  {GPIO_PORTD_NUM, GPIO_PIN1_NUM, ADC_SSMUX2, ADC_SSCTL2, ADC_SSFIFO2, 50},
-  {GPIO_PORTD_NUM, GPIO_PIN0_NUM, ADC_SSMUX3, ADC_SSCTL3, ADC_SSFIFO3, 51}
+  {GPIO_PORTE_NUM, GPIO_PIN3_NUM, ADC_SSMUX0, ADC_SSCTL0, ADC_SSFIFO0, 14, 14, 8},
+  {GPIO_PORTE_NUM, GPIO_PIN2_NUM, ADC_SSMUX1, ADC_SSCTL1, ADC_SSFIFO1, 15, 15, 4},
+  {GPIO_PORTE_NUM, GPIO_PIN1_NUM, ADC_SSMUX2, ADC_SSCTL2, ADC_SSFIFO2, 16, 16, 4},
+  {GPIO_PORTE_NUM, GPIO_PIN0_NUM, ADC_SSMUX3, ADC_SSCTL3, ADC_SSFIFO3, 17, 17, 1},
+  {GPIO_PORTD_NUM, GPIO_PIN3_NUM, ADC_SSMUX0, ADC_SSCTL0, ADC_SSFIFO0, 48, 24, 8},
+  {GPIO_PORTD_NUM, GPIO_PIN2_NUM, ADC_SSMUX1, ADC_SSCTL1, ADC_SSFIFO1, 49, 25, 4},
+  {GPIO_PORTD_NUM, GPIO_PIN1_NUM, ADC_SSMUX2, ADC_SSCTL2, ADC_SSFIFO2, 50, 26, 4},
+  {GPIO_PORTD_NUM, GPIO_PIN0_NUM, ADC_SSMUX3, ADC_SSCTL3, ADC_SSFIFO3, 51, 27, 1}
+};
+
+//------------------------------------------------------------------------------
+// Threads waiting for the conversions
+//------------------------------------------------------------------------------
+struct adc_waiter {
+  IO_sys_completion done;
+  volatile uint8_t  armed;  // the interrupt has been unmasked for the waiter
+  uint8_t           user;   // the user has enabled the events
 };
 
-static struct IO_io *adc_devices[8];
+static struct adc_waiter adc_waiters[8];
+
+//------------------------------------------------------------------------------
+// Rings of the continuous sampling; the DMA fills the two halves in the
+// ping-pong mode
+//------------------------------------------------------------------------------
+struct adc_stream {
+  uint16_t *data;
+  uint16_t  half;   // number of samples in a half
+  uint8_t   steps;  // number of samples in a sequence
+};
+
+static struct adc_stream adc_streams[8];
 
 //------------------------------------------------------------------------------
 // Handle interrupts
@@ -65,9 +99,30 @@ static struct IO_io *adc_devices[8];
 static void adc_handler(uint8_t module)
 {
   DEF_HELPERS(module);
+  struct adc_waiter *waiter = &adc_waiters[module];
+
+  //----------------------------------------------------------------------------
+  // In the continuous mode, we only get the DMA completions; the handler
+  // re-arms the half of the ring that is done
+  //----------------------------------------------------------------------------
+  if(adc_streams[module].data) {
+    if(TM4C_dma_check_interrupt(adc_info[module].dma_channel, 0))
+      TM4C_device_dispatch(TM4C_DEV_ADC + module, IO_EVENT_DONE);
+    return;
+  }
+
+  TM4C_device_dispatch(TM4C_DEV_ADC + module, IO_EVENT_DONE);
 
-  if(adc_devices[module] && adc_devices[module]->event)
-    adc_devices[module]->event(adc_devices[module], IO_EVENT_DONE);
+  //----------------------------------------------------------------------------
+  // The reader needs to see the raw status, so it acks the interrupt and
+  // unmasks it again if the user has asked for the events
+  //----------------------------------------------------------------------------
+  if(waiter->armed) {
+    ADC_REG(module_offset, ADC_IM) &= ~(1 << adc_sequencer);
+    waiter->armed = 0;
+    IO_sys_complete(&waiter->done);
+    return;
+  }
   ADC_REG(module_offset, ADC_ISC) |= (1 << adc_sequencer); // ack the interrupt
 }
 
@@ -119,13 +174,67 @@ static int32_t adc_read(IO_io *io, void *data, uint32_t length)
     if((ADC_REG(module_offset, ADC_RIS) & int_mask) == 0)
       return -IO_EWOULDBLOCK;
   }
-  else
-    while((ADC_REG(module_offset, ADC_RIS) & int_mask) == 0);
+  else {
+    //--------------------------------------------------------------------------
+    // Sleep until the sequencer is done if we can, the conversion interrupt
+    // wakes us up
+    //--------------------------------------------------------------------------
+    struct adc_waiter *waiter = &adc_waiters[io->channel];
+    while((ADC_REG(module_offset, ADC_RIS) & int_mask) == 0) {
+      if(!IO_sys_can_block())
+        continue;
+      IO_disable_interrupts();
+      waiter->armed = 1;
+      ADC_REG(module_offset, ADC_IM) |= int_mask;
+      IO_sys_completion_wait(&waiter->done);
+    }
+  }
   *val = ADC_REG(module_offset, fifo);
   ADC_REG(module_offset, ADC_ISC) |= int_mask;
+  if(adc_waiters[io->channel].user)
+    ADC_REG(module_offset, ADC_IM) |= int_mask;
   return 1;
 }
 
+//------------------------------------------------------------------------------
+// Read the latest complete sequence of the continuous sampling
+//------------------------------------------------------------------------------
+static int32_t adc_read_continuous(IO_io *io, void *data, uint32_t length)
+{
+  struct adc_stream *stream = &adc_streams[io->channel];
+  if(!length || length > stream->steps)
+    return -IO_EINVAL;
+
+  //----------------------------------------------------------------------------
+  // Find where the DMA is in the ring and step back to the beginning of the
+  // last sequence it has completed
+  //----------------------------------------------------------------------------
+  uint8_t  type;
+  uint32_t pos = TM4C_dma_pingpong_position(adc_info[io->channel].dma_channel,
+                                            &type);
+  if(type == DMA_TYPE_ALTERNATE)
+    pos += stream->half;
+
+  pos -= pos % stream->steps;
+  if(!pos)
+    pos = 2*stream->half;
+  pos -= stream->steps;
+
+  uint64_t *val = data;
+  for(uint32_t i = 0; i < length; ++i)
+    val[i] = stream->data[pos+i];
+  return length;
+}
+
+//------------------------------------------------------------------------------
+// The timer requests the samples in the continuous mode
+//------------------------------------------------------------------------------
+static int32_t adc_write_continuous(IO_io *io, const void *data,
+  uint32_t length)
+{
+  return -IO_EINVAL;
+}
+
 //------------------------------------------------------------------------------
 // Sync ADC
 //------------------------------------------------------------------------------
@@ -134,6 +243,49 @@ static int32_t adc_sync(IO_io *io)
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Enable ADC events
+//------------------------------------------------------------------------------
+static int32_t adc_event_enable(IO_io *io, uint16_t events)
+{
+  if(events != IO_EVENT_DONE)
+    return -IO_EINVAL;
+
+  DEF_HELPERS(io->channel);
+
+  adc_waiters[io->channel].user = 1;
+  ADC_REG(module_offset, ADC_IM) |= (1 << adc_sequencer);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Disable ADC events
+//------------------------------------------------------------------------------
+static int32_t adc_event_disable(IO_io *io, uint16_t events)
+{
+  if(events != IO_EVENT_DONE)
+    return -IO_EINVAL;
+
+  DEF_HELPERS(io->channel);
+
+  IO_disable_interrupts();
+  adc_waiters[io->channel].user = 0;
+  if(!adc_waiters[io->channel].armed)
+    ADC_REG(module_offset, ADC_IM) &= ~(1 << adc_sequencer);
+  IO_enable_interrupts();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Device operations
+//------------------------------------------------------------------------------
+static const IO_ops adc_ops = {
+  adc_write, 0, adc_read, adc_sync, adc_event_enable, adc_event_disable };
+
+static const IO_ops adc_ops_continuous = {
+  adc_write_continuous, 0, adc_read_continuous, adc_sync,
+  adc_event_enable, adc_event_disable };
+
 //------------------------------------------------------------------------------
 // Initialize an ADC
 //------------------------------------------------------------------------------
@@ -164,14 +316,22 @@ int32_t IO_adc_init(IO_io *io, uint8_t module, uint16_t flags)
   // turn off the sequencer
   ADC_REG(module_offset, ADC_ACTSS) &= ~(1 << adc_sequencer);
 
+  // drop the continuous sampling set up before, if any
+  if(adc_streams[module].data) {
+    TM4C_dma_channel_free(adc_info[module].dma_channel);
+    IO_free(adc_streams[module].data);
+    adc_streams[module].data = 0;
+  }
+  ADC_REG(module_offset, ADC_EMUX) &= ~(0x0f << (4*adc_sequencer));
+
   // select the pin
   ADC_REG(module_offset, adc_mux) = module;
 
   // make it the only pin in the sequence and assert the interrupt when done
   ADC_REG(module_offset, adc_ctl) = 0x06;
 
-  if(flags & IO_ASYNC)
-    TM4C_enable_interrupt(adc_info[module].interrupt, 7);
+  // the interrupt is needed for the events and to wake up the blocked threads
+  TM4C_enable_interrupt(adc_info[module].interrupt, 7);
 
   // turn on the sequencer
   ADC_REG(module_offset, ADC_ACTSS) |= (1 << adc_sequencer);
@@ -179,41 +339,143 @@ int32_t IO_adc_init(IO_io *io, uint8_t module, uint16_t flags)
   //----------------------------------------------------------------------------
   // Set up the software
   //----------------------------------------------------------------------------
+  io->channel = module;
   io->type    = IO_ADC;
   io->flags   = flags;
   io->event   = 0;
-  io->sync    = adc_sync;
-  io->read    = adc_read;
-  io->write   = adc_write;
-  adc_devices[module] = io;
+  io->ops     = &adc_ops;
+  TM4C_device_register(TM4C_DEV_ADC + module, io);
+  adc_waiters[module].armed = 0;
+  adc_waiters[module].user  = 0;
+  IO_sys_completion_init(&adc_waiters[module].done);
 
   return 0;
 }
 
 //------------------------------------------------------------------------------
-// Enable ADC events
+// Tear down the continuous sampling: stop the sequencer, release the DMA
+// channel and the ring
 //------------------------------------------------------------------------------
-int32_t TM4C_adc_event_enable(IO_io *io, uint16_t events)
+static void adc_stop_continuous(uint8_t module)
 {
-  if(events != IO_EVENT_DONE)
-    return -IO_EINVAL;
-
-  DEF_HELPERS(io->channel);
-
-  ADC_REG(module_offset, ADC_IM) |= (1 << adc_sequencer);
-  return 0;
+  DEF_HELPERS(module);
+  ADC_REG(module_offset, ADC_ACTSS) &= ~(1 << adc_sequencer);
+  TM4C_dma_channel_free(adc_info[module].dma_channel);
+  IO_free(adc_streams[module].data);
+  adc_streams[module].data = 0;
 }
 
 //------------------------------------------------------------------------------
-// Disable ADC events
+// Initialize an ADC sequencer sampling continuously
 //------------------------------------------------------------------------------
-int32_t TM4C_adc_event_disable(IO_io *io, uint16_t events)
+int32_t IO_adc_init_continuous(IO_io *io, uint8_t module, uint16_t flags,
+  const IO_adc_attrs *attrs)
 {
-  if(events != IO_EVENT_DONE)
+  if(module > 7 || !io || !attrs || (flags & (IO_DMA | IO_BUFFERED)))
     return -IO_EINVAL;
 
-  DEF_HELPERS(io->channel);
+  DEF_HELPERS(module);
+  uint8_t  steps = attrs->num_inputs;
+  uint32_t half  = attrs->depth * steps;
+
+  if(!steps || steps > adc_info[module].fifo_depth || attrs->oversample > 6 ||
+     !half || half > DMA_MAX_ITEMS || attrs->timer > 11 || !attrs->period)
+    return -IO_EINVAL;
+
+  for(uint8_t i = 0; i < steps; ++i)
+    if(attrs->inputs[i] > 7)
+      return -IO_EINVAL;
 
+  //----------------------------------------------------------------------------
+  // Get the ring
+  //----------------------------------------------------------------------------
+  struct adc_stream *stream = &adc_streams[module];
+  uint8_t dma_channel = adc_info[module].dma_channel;
+  if(TM4C_dma_channel_alloc(dma_channel, 0, 0, 0))
+    return -IO_EBUSY;
+
+  TM4C_dma_stop(dma_channel);
+  if(stream->data)
+    IO_free(stream->data);
+  stream->data = IO_malloc(2*half*sizeof(uint16_t));
+  if(!stream->data) {
+    adc_stop_continuous(module);
+    return -IO_ENOMEM;
+  }
+  memset(stream->data, 0, 2*half*sizeof(uint16_t));
+  stream->half  = half;
+  stream->steps = steps;
+
+  //----------------------------------------------------------------------------
+  // Set up the hardware
+  //----------------------------------------------------------------------------
+  if(module < 4)
+    RCGCADC_REG |= 0x01;
+  else
+    RCGCADC_REG |= 0x02;
+
+  for(uint8_t i = 0; i < steps; ++i) {
+    uint8_t port = adc_info[attrs->inputs[i]].gpio_port;
+    uint8_t pin  = adc_info[attrs->inputs[i]].gpio_pin;
+    TM4C_gpio_port_init(port);
+    TM4C_gpio_pin_init(port, pin, 0, 1, 0);
+  }
+
+  // turn off the sequencer
+  ADC_REG(module_offset, ADC_ACTSS) &= ~(1 << adc_sequencer);
+
+  // the timer triggers the sequence
+  ADC_REG(module_offset, ADC_EMUX) &= ~(0x0f << (4*adc_sequencer));
+  ADC_REG(module_offset, ADC_EMUX) |= (0x05 << (4*adc_sequencer));
+
+  // hardware averaging
+  ADC_REG(module_offset, ADC_SAC) = attrs->oversample;
+
+  // the inputs, the last step ends the sequence and requests the DMA
+  uint32_t mux = 0;
+  for(uint8_t i = 0; i < steps; ++i)
+    mux |= (attrs->inputs[i] << (4*i));
+  ADC_REG(module_offset, adc_info[module].mux) = mux;
+  ADC_REG(module_offset, adc_info[module].ctl) = 0x06 << (4*(steps-1));
   ADC_REG(module_offset, ADC_IM) &= ~(1 << adc_sequencer);
+
+  //----------------------------------------------------------------------------
+  // Half-word items from the FIFO to the ring
+  //----------------------------------------------------------------------------
+  uint32_t control = 0;
+  control |= (0x01 << 30);      // destination increments by a half-word
+  control |= (0x01 << 28);      // destination item size is a half-word
+  control |= (0x03 << 26);      // source does not increment
+  control |= (0x01 << 24);      // source item data size is a half-word
+
+  void *fifo = (void *)&ADC_REG(module_offset, adc_info[module].fifo);
+  TM4C_dma_set_task(TM4C_dma_get_control(dma_channel, DMA_TYPE_PRIMARY),
+                    fifo, stream->data, control, DMA_MODE_PINGPONG, half);
+  TM4C_dma_set_task(TM4C_dma_get_control(dma_channel, DMA_TYPE_ALTERNATE),
+                    fifo, stream->data+half, control, DMA_MODE_PINGPONG,
+                    half);
+  TM4C_dma_pingpong_start(dma_channel, 0);
+
+  // the DMA completions come through the sequencer interrupt
+  TM4C_enable_interrupt(adc_info[module].interrupt, 7);
+
+  // turn on the sequencer and start the trigger
+  ADC_REG(module_offset, ADC_ACTSS) |= (1 << adc_sequencer);
+  int32_t ret = TM4C_timer_adc_trigger(attrs->timer, attrs->period);
+  if(ret) {
+    adc_stop_continuous(module);
+    return ret;
+  }
+
+  //----------------------------------------------------------------------------
+  // Set up the software
+  //----------------------------------------------------------------------------
+  io->channel = module;
+  io->type    = IO_ADC;
+  io->flags   = flags;
+  io->event   = 0;
+  io->ops     = &adc_ops_continuous;
+  TM4C_device_register(TM4C_DEV_ADC + module, io);
+
   return 0;
 }
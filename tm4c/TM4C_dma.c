@@ -17,6 +17,9 @@
 // along with silly-invaders.  If not, see <http://www.gnu.org/licenses/>.
 //------------------------------------------------------------------------------
 
+#include <io/IO_error.h>
+#include <io/IO_malloc.h>
+#include <io/IO_sys.h>
 #include "TM4C.h"
 #include "TM4C_dma.h"
 
@@ -25,6 +28,39 @@
 //------------------------------------------------------------------------------
 static dma_control dma_control_table[64] __attribute__ ((aligned (1024)));
 
+//------------------------------------------------------------------------------
+// Channel state
+//------------------------------------------------------------------------------
+#define DMA_CHANNEL_ALLOCATED 0x01
+#define DMA_CHANNEL_PINGPONG  0x02
+#define DMA_CHANNEL_SOFTWARE  0x04
+
+struct dma_request {
+  const void        *src;
+  void              *dst;
+  uint32_t           control;
+  uint32_t           count;
+  TM4C_dma_callback  callback;
+  void              *arg;
+};
+
+struct dma_channel {
+  TM4C_dma_callback   callback;
+  void               *arg;
+  dma_control        *tasks;       // task list of the long transfers
+  struct dma_request *queue;       // transfers waiting for the channel
+  TM4C_dma_callback   current;     // callback of the running transfer
+  void               *current_arg;
+  uint32_t            pingpong[2]; // control words to re-arm with
+  IO_sys_completion   done;        // a thread waits for the channel
+  volatile uint8_t    in_flight;   // the running transfer and the queue
+  uint8_t             head;        // the next transfer in the queue
+  uint8_t             enc;
+  uint8_t             flags;
+};
+
+static struct dma_channel dma_channels[32];
+
 //------------------------------------------------------------------------------
 // Initialize the DMA controller
 //------------------------------------------------------------------------------
@@ -37,6 +73,9 @@ void TM4C_dma_init()
 
   // the address should already be 1024-aligned but we do it anyways
   DMACTLBASE_REG |= ((ctl_addr >> 10) << 10);
+
+  // completion of the software-initiated transfers
+  TM4C_enable_interrupt(46, 7);
 }
 
 //------------------------------------------------------------------------------
@@ -49,6 +88,487 @@ dma_control *TM4C_dma_get_control(uint8_t channel, uint8_t type)
   return &dma_control_table[channel+type*32];
 }
 
+//------------------------------------------------------------------------------
+// Allocate a DMA channel
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_channel_alloc(uint8_t channel, uint8_t enc,
+  TM4C_dma_callback callback, void *arg)
+{
+  if(channel > 31)
+    return -IO_EINVAL;
+
+  struct dma_channel *ch = &dma_channels[channel];
+  if((ch->flags & DMA_CHANNEL_ALLOCATED) && ch->enc != enc)
+    return -IO_EBUSY;
+
+  ch->callback = callback;
+  ch->arg      = arg;
+  ch->enc      = enc;
+  ch->flags    = DMA_CHANNEL_ALLOCATED;
+  ch->current  = 0;
+  ch->in_flight = 0;
+  ch->head     = 0;
+  IO_sys_completion_init(&ch->done);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Release a DMA channel
+//------------------------------------------------------------------------------
+void TM4C_dma_channel_free(uint8_t channel)
+{
+  if(channel > 31)
+    return;
+  TM4C_dma_stop(channel);
+  dma_channels[channel].flags    = 0;
+  dma_channels[channel].callback = 0;
+}
+
+//------------------------------------------------------------------------------
+// Check whether the channel is still transferring; the controller disables
+// the channel when it is done, but the completion handler may still have
+// queued transfers to start
+//------------------------------------------------------------------------------
+int TM4C_dma_busy(uint8_t channel)
+{
+  return dma_channels[channel].in_flight ||
+    (DMAENASET_REG & (1 << channel)) != 0;
+}
+
+//------------------------------------------------------------------------------
+// Get the number of transfers that have been started or queued and have not
+// completed yet
+//------------------------------------------------------------------------------
+uint8_t TM4C_dma_in_flight(uint8_t channel)
+{
+  if(channel > 31)
+    return 0;
+  return dma_channels[channel].in_flight;
+}
+
+//------------------------------------------------------------------------------
+// Check whether we need to keep waiting
+//------------------------------------------------------------------------------
+static int dma_over(uint8_t channel, uint8_t max)
+{
+  if(!max)
+    return TM4C_dma_busy(channel);
+  return dma_channels[channel].in_flight > max;
+}
+
+//------------------------------------------------------------------------------
+// Wait until no more than max transfers are in flight; the thread sleeps if
+// it can and the completion interrupt wakes it up
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_wait_queue(uint8_t channel, uint8_t max, uint8_t nonblocking)
+{
+  if(channel > 31)
+    return -IO_EINVAL;
+
+  while(dma_over(channel, max)) {
+    if(nonblocking)
+      return -IO_EWOULDBLOCK;
+
+    if(!IO_sys_can_block())
+      continue;
+
+    IO_disable_interrupts();
+    if(!dma_over(channel, max)) {
+      IO_enable_interrupts();
+      break;
+    }
+    IO_sys_completion_wait(&dma_channels[channel].done);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Wait until the channel is done
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_wait(uint8_t channel, uint8_t nonblocking)
+{
+  return TM4C_dma_wait_queue(channel, 0, nonblocking);
+}
+
+//------------------------------------------------------------------------------
+// Stop the channel
+//------------------------------------------------------------------------------
+void TM4C_dma_stop(uint8_t channel)
+{
+  IO_disable_interrupts();
+  dma_channels[channel].flags &= ~DMA_CHANNEL_PINGPONG;
+  dma_channels[channel].in_flight = 0;
+  dma_channels[channel].current = 0;
+  DMAENACLR_REG = (1 << channel);
+  IO_enable_interrupts();
+  IO_sys_complete(&dma_channels[channel].done);
+}
+
+//------------------------------------------------------------------------------
+// Set a control structure up; the controller wants the addresses of the last
+// items of the buffers that increment
+//------------------------------------------------------------------------------
+void TM4C_dma_set_task(dma_control *ctrl, const void *src, void *dst,
+  uint32_t control, uint8_t mode, uint16_t count)
+{
+  uint8_t src_inc = (control >> 26) & 0x03;
+  uint8_t dst_inc = (control >> 30) & 0x03;
+
+  ctrl->src = (void *)src;
+  if(src_inc != 0x03)
+    ctrl->src = (uint8_t *)src + ((count-1) << src_inc);
+
+  ctrl->dst = dst;
+  if(dst_inc != 0x03)
+    ctrl->dst = (uint8_t *)dst + ((count-1) << dst_inc);
+
+  ctrl->control  = control & 0xffffc000;
+  ctrl->control |= ((count-1) << 4);
+  ctrl->control |= mode;
+}
+
+//------------------------------------------------------------------------------
+// Point the primary control structure at a task list
+//------------------------------------------------------------------------------
+static void set_task_list(uint8_t channel, dma_control *tasks, uint8_t num,
+  uint8_t mode)
+{
+  dma_control *pri = &dma_control_table[channel];
+  dma_control *alt = &dma_control_table[channel+32];
+
+  // the tasks are copied word by word to the alternate control structure
+  TM4C_dma_set_task(pri, tasks, alt,
+                    (0x02 << 30) | (0x02 << 28) | // dst: words
+                    (0x02 << 26) | (0x02 << 24) | // src: words
+                    (0x02 << 14),                 // arbitrate after a task
+                    mode, 4*num);
+  // both ends need to point at the last word of a task though
+  pri->src = &tasks[num-1].reserved;
+  pri->dst = &alt->reserved;
+}
+
+//------------------------------------------------------------------------------
+// Claim an idle channel for a transfer that does not go through the queue
+//------------------------------------------------------------------------------
+static int32_t claim_channel(uint8_t channel)
+{
+  struct dma_channel *ch = &dma_channels[channel];
+  IO_disable_interrupts();
+  if(TM4C_dma_busy(channel)) {
+    IO_enable_interrupts();
+    return -IO_EBUSY;
+  }
+  ch->current   = 0;
+  ch->in_flight = 1;
+  IO_enable_interrupts();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Start a list of scatter-gather tasks on a claimed channel
+//------------------------------------------------------------------------------
+static void start_scatter_gather(uint8_t channel, uint8_t enc,
+  dma_control *tasks, uint8_t num, uint8_t peripheral)
+{
+  uint8_t mode = peripheral ? DMA_MODE_PER_SG_ALT : DMA_MODE_MEM_SG_ALT;
+  uint8_t last = peripheral ? DMA_MODE_BASIC : DMA_MODE_AUTO;
+  for(int i = 0; i < num; ++i)
+    tasks[i].control = (tasks[i].control & ~0x07) | (i == num-1 ? last : mode);
+
+  set_task_list(channel, tasks, num,
+                peripheral ? DMA_MODE_PER_SG : DMA_MODE_MEM_SG);
+
+  TM4C_dma_run_transfer(channel, enc);
+  if(!peripheral) {
+    dma_channels[channel].flags |= DMA_CHANNEL_SOFTWARE;
+    DMASWREQ_REG = (1 << channel);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Run a list of scatter-gather tasks; the control structures of the channel
+// are rewritten, so it needs to be idle
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_scatter_gather(uint8_t channel, uint8_t enc,
+  dma_control *tasks, uint8_t num, uint8_t peripheral)
+{
+  if(channel > 31 || !num)
+    return -IO_EINVAL;
+
+  int32_t ret = claim_channel(channel);
+  if(ret)
+    return ret;
+
+  start_scatter_gather(channel, enc, tasks, num, peripheral);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Split a transfer into tasks of at most DMA_MAX_ITEMS items and append them
+// to the task list of the channel; returns the number of items that fit
+//------------------------------------------------------------------------------
+static uint32_t add_tasks(struct dma_channel *ch, uint8_t *num,
+  const void *src, void *dst, uint32_t control, uint32_t count)
+{
+  uint8_t src_inc = (control >> 26) & 0x03;
+  uint8_t dst_inc = (control >> 30) & 0x03;
+  const uint8_t *s = src;
+  uint8_t *d = dst;
+  uint32_t added = 0;
+  while(count && *num < DMA_MAX_TASKS) {
+    uint16_t items = count > DMA_MAX_ITEMS ? DMA_MAX_ITEMS : count;
+    TM4C_dma_set_task(&ch->tasks[(*num)++], s, d, control, DMA_MODE_STOP,
+                      items);
+    if(src_inc != 0x03)
+      s += items << src_inc;
+    if(dst_inc != 0x03)
+      d += items << dst_inc;
+    count -= items;
+    added += items;
+  }
+  return added;
+}
+
+//------------------------------------------------------------------------------
+// Make sure that the channel has a task list
+//------------------------------------------------------------------------------
+static int32_t get_tasks(struct dma_channel *ch)
+{
+  if(!ch->tasks) {
+    ch->tasks = IO_malloc(DMA_MAX_TASKS*sizeof(dma_control));
+    if(!ch->tasks)
+      return -IO_ENOMEM;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Run the task list of a peripheral transfer; a single task runs in the basic
+// mode
+//------------------------------------------------------------------------------
+static void run_tasks(uint8_t channel, uint8_t enc, uint8_t num)
+{
+  dma_control *tasks = dma_channels[channel].tasks;
+  if(num == 1) {
+    dma_control_table[channel] = tasks[0];
+    dma_control_table[channel].control |= DMA_MODE_BASIC;
+    TM4C_dma_run_transfer(channel, enc);
+  }
+  else
+    start_scatter_gather(channel, enc, tasks, num, 1);
+}
+
+//------------------------------------------------------------------------------
+// Start a peripheral transfer; short transfers run in the basic mode, long
+// ones are split into tasks
+//------------------------------------------------------------------------------
+static void start_request(uint8_t channel, const struct dma_request *req)
+{
+  struct dma_channel *ch = &dma_channels[channel];
+  ch->current     = req->callback;
+  ch->current_arg = req->arg;
+
+  if(req->count <= DMA_MAX_ITEMS) {
+    TM4C_dma_set_task(&dma_control_table[channel], req->src, req->dst,
+                      req->control, DMA_MODE_BASIC, req->count);
+    TM4C_dma_run_transfer(channel, ch->enc);
+    return;
+  }
+
+  uint8_t num = 0;
+  add_tasks(ch, &num, req->src, req->dst, req->control, req->count);
+  run_tasks(channel, ch->enc, num);
+}
+
+//------------------------------------------------------------------------------
+// Start or queue a peripheral transfer of any length
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_submit(uint8_t channel, uint8_t enc, const void *src,
+  void *dst, uint32_t control, uint32_t count, TM4C_dma_callback callback,
+  void *arg)
+{
+  if(channel > 31 || !count)
+    return -IO_EINVAL;
+
+  if(count > DMA_MAX_ITEMS*DMA_MAX_TASKS)
+    count = DMA_MAX_ITEMS*DMA_MAX_TASKS;
+
+  //----------------------------------------------------------------------------
+  // Get the memory now, the queue is served from the interrupt handler
+  //----------------------------------------------------------------------------
+  struct dma_channel *ch = &dma_channels[channel];
+  int32_t ret = get_tasks(ch);
+  if(ret)
+    return ret;
+
+  if(!ch->queue) {
+    ch->queue = IO_malloc(DMA_MAX_IN_FLIGHT*sizeof(struct dma_request));
+    if(!ch->queue)
+      return -IO_ENOMEM;
+  }
+
+  struct dma_request req = {src, dst, control, count, callback, arg};
+  ch->enc = enc;
+
+  IO_disable_interrupts();
+  if(ch->in_flight >= DMA_MAX_IN_FLIGHT) {
+    IO_enable_interrupts();
+    return -IO_EBUSY;
+  }
+
+  if(!ch->in_flight++)
+    start_request(channel, &req);
+  else {
+    uint8_t slot = (ch->head + ch->in_flight - 2) % DMA_MAX_IN_FLIGHT;
+    ch->queue[slot] = req;
+  }
+  IO_enable_interrupts();
+  return count;
+}
+
+//------------------------------------------------------------------------------
+// Run a peripheral transfer of any length
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_transfer(uint8_t channel, uint8_t enc, const void *src,
+  void *dst, uint32_t control, uint32_t count)
+{
+  return TM4C_dma_submit(channel, enc, src, dst, control, count, 0, 0);
+}
+
+//------------------------------------------------------------------------------
+// Gather a list of buffers into a peripheral
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_gather(uint8_t channel, uint8_t enc, const IO_iovec *iov,
+  uint32_t num, void *dst, uint32_t control)
+{
+  if(channel > 31)
+    return -IO_EINVAL;
+
+  //----------------------------------------------------------------------------
+  // The chain bypasses the queue and reuses the task list, so the channel
+  // needs to be idle
+  //----------------------------------------------------------------------------
+  struct dma_channel *ch = &dma_channels[channel];
+  int32_t ret = get_tasks(ch);
+  if(ret)
+    return ret;
+
+  ret = claim_channel(channel);
+  if(ret)
+    return ret;
+
+  uint8_t  num_tasks = 0;
+  uint32_t count     = 0;
+  for(uint32_t i = 0; i < num && num_tasks < DMA_MAX_TASKS; ++i) {
+    if(!iov[i].length)
+      continue;
+    uint32_t added = add_tasks(ch, &num_tasks, iov[i].base, dst, control,
+                               iov[i].length);
+    count += added;
+    if(added != iov[i].length)
+      break;
+  }
+
+  if(num_tasks)
+    run_tasks(channel, enc, num_tasks);
+  else
+    ch->in_flight = 0;
+  return count;
+}
+
+//------------------------------------------------------------------------------
+// Start a ping-pong transfer
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_pingpong_start(uint8_t channel, uint8_t enc)
+{
+  if(channel > 31)
+    return -IO_EINVAL;
+
+  struct dma_channel *ch = &dma_channels[channel];
+  ch->pingpong[DMA_TYPE_PRIMARY]   = dma_control_table[channel].control;
+  ch->pingpong[DMA_TYPE_ALTERNATE] = dma_control_table[channel+32].control;
+  ch->flags |= DMA_CHANNEL_PINGPONG;
+  TM4C_dma_run_transfer(channel, enc);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Get the position of a ping-pong transfer; a completed structure has its
+// mode cleared and counts as full until the handler re-arms it
+//------------------------------------------------------------------------------
+uint16_t TM4C_dma_pingpong_position(uint8_t channel, uint8_t *type)
+{
+  uint8_t t = DMA_TYPE_PRIMARY;
+  if(DMAALTSET_REG & (1 << channel))
+    t = DMA_TYPE_ALTERNATE;
+
+  uint32_t control = dma_control_table[channel+t*32].control;
+  uint16_t total   = ((dma_channels[channel].pingpong[t] >> 4) & 0x3ff) + 1;
+  uint16_t left    = 0;
+  if(control & 0x07)
+    left = ((control >> 4) & 0x3ff) + 1;
+
+  *type = t;
+  return total - left;
+}
+
+//------------------------------------------------------------------------------
+// Handle a completion; in the ping-pong mode the controller has already
+// switched to the other structure, so the one that is not active is done
+//------------------------------------------------------------------------------
+static void dma_complete(uint8_t channel)
+{
+  struct dma_channel *ch = &dma_channels[channel];
+  uint8_t type = DMA_TYPE_PRIMARY;
+  if((ch->flags & DMA_CHANNEL_PINGPONG) && !(DMAALTSET_REG & (1 << channel)))
+    type = DMA_TYPE_ALTERNATE;
+
+  if(ch->flags & DMA_CHANNEL_PINGPONG) {
+    if(ch->callback)
+      ch->callback(channel, type, ch->arg);
+    dma_control_table[channel+type*32].control = ch->pingpong[type];
+    DMAENASET_REG = (1 << channel); // in case it has run dry in the meantime
+    IO_sys_complete(&ch->done);
+    return;
+  }
+
+  //----------------------------------------------------------------------------
+  // Start the next queued transfer first to keep the peripheral busy, then
+  // report the one that is done
+  //----------------------------------------------------------------------------
+  TM4C_dma_callback current = ch->current;
+  void *current_arg = ch->current_arg;
+  ch->current = 0;
+
+  if(ch->in_flight && --ch->in_flight) {
+    start_request(channel, &ch->queue[ch->head]);
+    ch->head = (ch->head + 1) % DMA_MAX_IN_FLIGHT;
+  }
+
+  if(current)
+    current(channel, type, current_arg);
+
+  if(ch->callback)
+    ch->callback(channel, type, ch->arg);
+
+  IO_sys_complete(&ch->done);
+}
+
+//------------------------------------------------------------------------------
+// Completion of the software-initiated transfers
+//------------------------------------------------------------------------------
+void udma_soft_handler()
+{
+  for(uint8_t i = 0; i < 32; ++i) {
+    if(!(dma_channels[i].flags & DMA_CHANNEL_SOFTWARE) ||
+       !(DMACHIS_REG & (1 << i)))
+      continue;
+    DMACHIS_REG = (1 << i);
+    dma_channels[i].flags &= ~DMA_CHANNEL_SOFTWARE;
+    dma_complete(i);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Initiate the DMA transfer on the given chanel and encoding
 //------------------------------------------------------------------------------
@@ -76,7 +596,8 @@ int TM4C_dma_check_interrupt(uint8_t channel, uint8_t enc)
     return 0;
 
   if(DMACHIS_REG & (1 << channel)) {
-    DMACHIS_REG |= (1 << channel);
+    DMACHIS_REG = (1 << channel); // write one to clear
+    dma_complete(channel);
     return 1;
   }
   return 0;
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <io/IO.h>
 
 //------------------------------------------------------------------------------
 //! DMA control structure
@@ -41,6 +42,171 @@ void TM4C_dma_init();
 #define DMA_TYPE_PRIMARY 0
 #define DMA_TYPE_ALTERNATE 1
 
+//------------------------------------------------------------------------------
+// Transfer modes, the lowest three bits of the control word
+//------------------------------------------------------------------------------
+#define DMA_MODE_STOP          0x00
+#define DMA_MODE_BASIC         0x01
+#define DMA_MODE_AUTO          0x02
+#define DMA_MODE_PINGPONG      0x03
+#define DMA_MODE_MEM_SG        0x04
+#define DMA_MODE_MEM_SG_ALT    0x05
+#define DMA_MODE_PER_SG        0x06
+#define DMA_MODE_PER_SG_ALT    0x07
+
+#define DMA_MAX_ITEMS 1024 //!< maximum number of items of a single task
+#define DMA_MAX_TASKS 8    //!< maximum number of tasks of a long transfer
+#define DMA_MAX_IN_FLIGHT 4 //!< maximum number of submitted transfers
+
+//------------------------------------------------------------------------------
+//! Completion callback; called from the interrupt handler of the peripheral
+//! owning the channel or from the uDMA software interrupt
+//!
+//! @param channel the channel
+//! @param type    the control structure that has completed
+//! @param arg     user argument
+//------------------------------------------------------------------------------
+typedef void (*TM4C_dma_callback)(uint8_t channel, uint8_t type, void *arg);
+
+//------------------------------------------------------------------------------
+//! Allocate a DMA channel
+//!
+//! @param channel  the channel number
+//! @param enc      the channel encoding
+//! @param callback completion callback, may be null
+//! @param arg      argument to the callback
+//! @return         -IO_EBUSY if the channel is in use with another encoding
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_channel_alloc(uint8_t channel, uint8_t enc,
+  TM4C_dma_callback callback, void *arg);
+
+//------------------------------------------------------------------------------
+//! Release a DMA channel, stopping whatever it does
+//------------------------------------------------------------------------------
+void TM4C_dma_channel_free(uint8_t channel);
+
+//------------------------------------------------------------------------------
+//! Check whether the channel is still transferring or has transfers queued
+//------------------------------------------------------------------------------
+int TM4C_dma_busy(uint8_t channel);
+
+//------------------------------------------------------------------------------
+//! Get the number of transfers in flight, ie. the running one and the ones
+//! queued behind it; a producer can keep the channel saturated by submitting
+//! while it is below DMA_MAX_IN_FLIGHT
+//------------------------------------------------------------------------------
+uint8_t TM4C_dma_in_flight(uint8_t channel);
+
+//------------------------------------------------------------------------------
+//! Wait until no more than max transfers are in flight
+//!
+//! @param channel     the channel
+//! @param max         number of transfers that may stay in flight; 0 waits
+//!                    for the channel to be done
+//! @param nonblocking return -IO_EWOULDBLOCK instead of waiting
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_wait_queue(uint8_t channel, uint8_t max, uint8_t nonblocking);
+
+//------------------------------------------------------------------------------
+//! Wait until the channel is done transferring
+//!
+//! The calling thread sleeps until the completion interrupt when the
+//! operating system runs, and spins otherwise. The interrupt of the
+//! peripheral owning the channel needs to be enabled.
+//!
+//! @param channel     the channel
+//! @param nonblocking return -IO_EWOULDBLOCK instead of waiting
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_wait(uint8_t channel, uint8_t nonblocking);
+
+//------------------------------------------------------------------------------
+//! Stop the channel
+//------------------------------------------------------------------------------
+void TM4C_dma_stop(uint8_t channel);
+
+//------------------------------------------------------------------------------
+//! Set a control structure up
+//!
+//! @param ctrl    the control structure or a scatter-gather task
+//! @param src     first source item
+//! @param dst     first destination item
+//! @param control item sizes, increments and arbitration size
+//! @param mode    transfer mode
+//! @param count   number of items, up to DMA_MAX_ITEMS
+//------------------------------------------------------------------------------
+void TM4C_dma_set_task(dma_control *ctrl, const void *src, void *dst,
+  uint32_t control, uint8_t mode, uint16_t count);
+
+//------------------------------------------------------------------------------
+//! Run a peripheral transfer of any length or queue it behind the running one
+//!
+//! Transfers longer than DMA_MAX_ITEMS are split into tasks executed in the
+//! peripheral scatter-gather mode. The queued transfers are started from the
+//! completion interrupt, so the buffers need to stay valid until the callback
+//! has been called.
+//!
+//! @param callback called when this transfer is done, may be null
+//! @param arg      argument to the callback
+//! @return         number of items that will be transferred, up to
+//!                 DMA_MAX_ITEMS*DMA_MAX_TASKS; -IO_EBUSY if there are
+//!                 DMA_MAX_IN_FLIGHT transfers in flight already
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_submit(uint8_t channel, uint8_t enc, const void *src,
+  void *dst, uint32_t control, uint32_t count, TM4C_dma_callback callback,
+  void *arg);
+
+//------------------------------------------------------------------------------
+//! Submit a peripheral transfer without a callback
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_transfer(uint8_t channel, uint8_t enc, const void *src,
+  void *dst, uint32_t control, uint32_t count);
+
+//------------------------------------------------------------------------------
+//! Gather a list of buffers into a peripheral in one scatter-gather chain
+//!
+//! @param dst     the data register of the peripheral
+//! @param control item sizes and arbitration size; the destination must not
+//!                increment
+//! @return        number of items that will be transferred; the chain holds
+//!                up to DMA_MAX_TASKS tasks; -IO_EBUSY if the channel has
+//!                transfers running or queued
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_gather(uint8_t channel, uint8_t enc, const IO_iovec *iov,
+  uint32_t num, void *dst, uint32_t control);
+
+//------------------------------------------------------------------------------
+//! Run a list of scatter-gather tasks
+//!
+//! The modes of the tasks are fixed up as needed. Memory transfers are
+//! started with a software request.
+//!
+//! @param tasks      the task list, needs to stay valid until completion
+//! @param num        number of tasks
+//! @param peripheral whether the transfer is paced by a peripheral
+//! @return           -IO_EBUSY if the channel has transfers running or queued
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_scatter_gather(uint8_t channel, uint8_t enc,
+  dma_control *tasks, uint8_t num, uint8_t peripheral);
+
+//------------------------------------------------------------------------------
+//! Start a ping-pong transfer
+//!
+//! Both control structures need to be set up in the ping-pong mode first.
+//! Every time one of them completes, the callback is called to refill its
+//! buffer and the structure is re-armed with its original control word, while
+//! the other one keeps the data flowing. Call TM4C_dma_stop to finish.
+//------------------------------------------------------------------------------
+int32_t TM4C_dma_pingpong_start(uint8_t channel, uint8_t enc);
+
+//------------------------------------------------------------------------------
+//! Get the position of a running ping-pong transfer
+//!
+//! @param channel the channel
+//! @param type    gets the control structure that is active
+//! @return        number of items transferred by the active structure
+//------------------------------------------------------------------------------
+uint16_t TM4C_dma_pingpong_position(uint8_t channel, uint8_t *type);
+
 //------------------------------------------------------------------------------
 //! Get the DMA control structure for the given channel
 //!
@@ -58,7 +224,8 @@ dma_control *TM4C_dma_get_control(uint8_t channel, uint8_t type);
 void TM4C_dma_run_transfer(uint8_t channel, uint8_t enc);
 
 //------------------------------------------------------------------------------
-//! Check the interrupt status for the given channel
+//! Check the interrupt status for the given channel and run the completion
+//! callback if there is one
 //!
 //! @param channel DMA channel
 //! @param enc     channel encoding
@@ -19,6 +19,8 @@
 
 #include <io/IO.h>
 #include <io/IO_error.h>
+#include <io/IO_malloc.h>
+#include <io/IO_sys.h>
 #include "TM4C.h"
 #include "TM4C_gpio.h"
 
@@ -83,7 +85,29 @@ void TM4C_gpio_pin_unlock(uint8_t port, uint8_t pin)
   GPIO_REG(port_offset, GPIO_CR)   |= (1 << pin);
 }
 
-static struct IO_io *gpio_devices[45];
+//------------------------------------------------------------------------------
+// Debouncing; the first edge masks the pin interrupt and the millisecond
+// tick re-samples the pin once the window has passed
+//------------------------------------------------------------------------------
+struct gpio_debounce {
+  uint64_t          stamp;   // time of the edge that started the window
+  uint64_t          changed; // time of the edge behind the current state
+  uint16_t          window;  // length of the window in miliseconds
+  volatile uint16_t left;    // miliseconds left until re-sampling
+  uint8_t           state;   // debounced state of the pin
+  uint8_t           notify;  // the user has enabled the events
+};
+
+static struct gpio_debounce *gpio_debounce[45];
+static volatile uint64_t gpio_debounce_pending;
+
+//------------------------------------------------------------------------------
+// Check whether the pin is high
+//------------------------------------------------------------------------------
+static uint8_t gpio_level(uint8_t pin)
+{
+  return GPIO_DATA_REG((pin / 8) * GPIO_PORT_OFFSET, pin % 8) != 0;
+}
 
 //------------------------------------------------------------------------------
 // Handle interrupts
@@ -94,13 +118,58 @@ static void gpio_handler(uint8_t port)
   uint8_t  pi = port * 8;
   for(int i = 0; i < 8; ++i) {
     if(GPIO_REG(port_offset, GPIO_MIS) & (1 << i)) {
-      if(gpio_devices[pi+i] && gpio_devices[pi+i]->event)
-        gpio_devices[pi+i]->event(gpio_devices[pi+i], IO_EVENT_CHANGE);
+      struct gpio_debounce *db = gpio_debounce[pi+i];
+      if(db) {
+        // ignore the bounces until the window has passed
+        GPIO_REG(port_offset, GPIO_IM) &= ~(1 << i);
+        db->stamp = IO_time();
+        db->left  = db->window;
+        gpio_debounce_pending |= (1ULL << (pi+i));
+      }
+      else
+        TM4C_device_dispatch(TM4C_DEV_GPIO + pi + i, IO_EVENT_CHANGE);
       GPIO_REG(port_offset, GPIO_ICR) |= (1 << i); // ack the interrupt
     }
   }
 }
 
+//------------------------------------------------------------------------------
+// Re-sample the pins whose windows have passed; called every milisecond
+//------------------------------------------------------------------------------
+void TM4C_gpio_debounce_tick()
+{
+  if(!gpio_debounce_pending)
+    return;
+
+  for(uint8_t pin = 0; pin < 45; ++pin) {
+    if(!(gpio_debounce_pending & (1ULL << pin)))
+      continue;
+
+    struct gpio_debounce *db = gpio_debounce[pin];
+    if(db->left && --db->left)
+      continue;
+
+    gpio_debounce_pending &= ~(1ULL << pin);
+
+    //--------------------------------------------------------------------------
+    // Clear the edges seen during the window before sampling; whatever comes
+    // after the sample fires as soon as we unmask the pin
+    //--------------------------------------------------------------------------
+    uint16_t port_offset = (pin / 8) * GPIO_PORT_OFFSET;
+    GPIO_REG(port_offset, GPIO_ICR) |= (1 << (pin % 8));
+    uint8_t level = gpio_level(pin);
+    GPIO_REG(port_offset, GPIO_IM) |= (1 << (pin % 8));
+
+    if(level == db->state)
+      continue;
+
+    db->state   = level;
+    db->changed = db->stamp;
+    if(db->notify)
+      TM4C_device_dispatch(TM4C_DEV_GPIO + pin, IO_EVENT_CHANGE);
+  }
+}
+
 void gpio_porta_handler() { gpio_handler(0); }
 void gpio_portb_handler() { gpio_handler(1); }
 void gpio_portc_handler() { gpio_handler(2); }
@@ -152,7 +221,9 @@ static int32_t gpio_read(IO_io *io, void *data, uint32_t length)
   int port = (io->channel / 8) * GPIO_PORT_OFFSET;
   int pin  = io->channel % 8;
 
-  if(GPIO_DATA_REG(port, pin))
+  if(gpio_debounce[io->channel])
+    *val = gpio_debounce[io->channel]->state;
+  else if(GPIO_DATA_REG(port, pin))
     *val = 1;
   else
     *val = 0;
@@ -169,6 +240,53 @@ static int32_t gpio_sync(IO_io *io)
 }
 
 
+//------------------------------------------------------------------------------
+// Enable GPIO events
+//------------------------------------------------------------------------------
+static int32_t gpio_event_enable(IO_io *io, uint16_t events)
+{
+  if(events != IO_EVENT_CHANGE)
+    return -IO_EINVAL;
+
+  int port = (io->channel / 8) * GPIO_PORT_OFFSET;
+  int pin  = io->channel % 8;
+
+  if(gpio_debounce[io->channel]) {
+    gpio_debounce[io->channel]->notify = 1;
+    return 0;
+  }
+
+  GPIO_REG(port, GPIO_IM) |= (1 << pin);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Disable gpio events
+//------------------------------------------------------------------------------
+static int32_t gpio_event_disable(IO_io *io, uint16_t events)
+{
+  if(events != IO_EVENT_CHANGE)
+    return -IO_EINVAL;
+
+  int port = (io->channel / 8) * GPIO_PORT_OFFSET;
+  int pin  = io->channel % 8;
+
+  if(gpio_debounce[io->channel]) {
+    gpio_debounce[io->channel]->notify = 0;
+    return 0;
+  }
+
+  GPIO_REG(port, GPIO_IM) &= ~(1 << pin);
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Device operations
+//------------------------------------------------------------------------------
+static const IO_ops gpio_ops = {
+  gpio_write, 0, gpio_read, gpio_sync, gpio_event_enable, gpio_event_disable };
+
 //------------------------------------------------------------------------------
 // Initialize a GPIO pin
 //------------------------------------------------------------------------------
@@ -202,40 +320,55 @@ int32_t IO_gpio_init(IO_io *io, uint8_t pin, uint16_t flags, uint8_t dir)
   io->type    = IO_GPIO;
   io->flags   = flags;
   io->event   = 0;
-  io->read    = gpio_read;
-  io->write   = gpio_write;
-  io->sync    = gpio_sync;
-  gpio_devices[pin] = io;
+  io->ops     = &gpio_ops;
+  TM4C_device_register(TM4C_DEV_GPIO + pin, io);
+  if(gpio_debounce[pin]) {
+    IO_free(gpio_debounce[pin]);
+    gpio_debounce[pin] = 0;
+    gpio_debounce_pending &= ~(1ULL << pin);
+  }
   return 0;
 }
 
 //------------------------------------------------------------------------------
-// Enable GPIO events
+// Debounce a GPIO input
 //------------------------------------------------------------------------------
-int32_t TM4C_gpio_event_enable(IO_io *io, uint16_t events)
+int32_t IO_gpio_debounce(IO_io *io, uint16_t window)
 {
-  if(events != IO_EVENT_CHANGE)
+  if(io->type != IO_GPIO || io->flags != IO_ASYNC || !window)
     return -IO_EINVAL;
 
-  int port = (io->channel / 8) * GPIO_PORT_OFFSET;
-  int pin  = io->channel % 8;
+  uint8_t pin = io->channel;
+  uint16_t port_offset = (pin / 8) * GPIO_PORT_OFFSET;
+  struct gpio_debounce *db = gpio_debounce[pin];
+  if(!db) {
+    db = IO_malloc(sizeof(struct gpio_debounce));
+    if(!db)
+      return -IO_ENOMEM;
+    // carry over the events enabled so far
+    db->notify = (GPIO_REG(port_offset, GPIO_IM) & (1 << (pin % 8))) != 0;
+  }
 
-  GPIO_REG(port, GPIO_IM) |= (1 << pin);
+  IO_disable_interrupts();
+  db->window  = window;
+  db->left    = 0;
+  db->state   = gpio_level(pin);
+  db->stamp   = IO_time();
+  db->changed = db->stamp;
+  gpio_debounce[pin] = db;
+
+  // the edges drive the debouncing whether the user wants the events or not
+  GPIO_REG(port_offset, GPIO_IM) |= (1 << (pin % 8));
+  IO_enable_interrupts();
   return 0;
 }
 
 //------------------------------------------------------------------------------
-// Disable gpio events
+// Get the time of the edge that started the last debounced change
 //------------------------------------------------------------------------------
-int32_t TM4C_gpio_event_disable(IO_io *io, uint16_t events)
+uint64_t IO_gpio_timestamp(IO_io *io)
 {
-  if(events != IO_EVENT_CHANGE)
-    return -IO_EINVAL;
-
-  int port = (io->channel / 8) * GPIO_PORT_OFFSET;
-  int pin  = io->channel % 8;
-
-  GPIO_REG(port, GPIO_IM) &= ~(1 << pin);
-
-  return 0;
+  if(io->type != IO_GPIO || !gpio_debounce[io->channel])
+    return 0;
+  return gpio_debounce[io->channel]->changed;
 }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <io/IO.h>
 
 //------------------------------------------------------------------------------
 //! Initialize GPIO port
@@ -38,7 +39,6 @@ void TM4C_gpio_pin_init(uint8_t port, uint8_t pin, uint8_t afsel,
 void TM4C_gpio_pin_unlock(uint8_t port, uint8_t pin);
 
 //------------------------------------------------------------------------------
-// Enable/disable GPIO events
+//! Re-sample the debounced pins; to be called every milisecond
 //------------------------------------------------------------------------------
-int32_t TM4C_gpio_event_enable(IO_io *io, uint16_t events);
-int32_t TM4C_gpio_event_disable(IO_io *io, uint16_t events);
+void TM4C_gpio_debounce_tick();
@@ -74,6 +74,21 @@ int32_t IO_slider_init(IO_io *io, uint8_t module, uint16_t flags)
   if(module > 0)
     return -IO_EINVAL;
 
+  //----------------------------------------------------------------------------
+  // Sample at 100Hz averaging 64 conversions, with 40ms worth of samples in
+  // the ring
+  //----------------------------------------------------------------------------
+  if(flags & IO_BUFFERED) {
+    IO_adc_attrs attrs;
+    attrs.inputs[0]  = 0;
+    attrs.num_inputs = 1;
+    attrs.oversample = 6;
+    attrs.timer      = 5;
+    attrs.depth      = 2;
+    attrs.period     = 10000000;
+    return IO_adc_init_continuous(io, 0, flags & ~IO_BUFFERED, &attrs);
+  }
+
   return IO_adc_init(io, 0, flags);
 }
 
@@ -90,6 +105,8 @@ static int32_t display_sync(IO_io *io)
   return PCD8544_sync(&display0);
 }
 
+static const IO_ops display_ops = { 0, 0, 0, display_sync, 0, 0 };
+
 //------------------------------------------------------------------------------
 // Initialize a display device
 //------------------------------------------------------------------------------
@@ -102,11 +119,9 @@ int32_t IO_display_init_low(IO_io *io, uint8_t module)
   // Initialize the display 0
   //----------------------------------------------------------------------------
   io->type    = IO_DISPLAY;
-  io->sync    = display_sync;
+  io->ops     = &display_ops;
   io->channel = 0;
   io->flags   = 0;
-  io->read    = 0;
-  io->write   = 0;
   io->event   = 0;
   return PCD8544_init(&display0, 0, 6, 7);
 }
@@ -144,6 +159,147 @@ int32_t IO_display_put_pixel(IO_io *io, uint16_t x, uint16_t y, uint32_t argb)
   return PCD8544_put_pixel(&display0, x, y, argb);
 }
 
+//------------------------------------------------------------------------------
+// Blit packed columns
+//------------------------------------------------------------------------------
+int32_t IO_display_blit_low(IO_io *io, uint16_t x, uint16_t y, uint16_t width,
+  uint16_t height, const uint8_t *data)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_blit(&display0, x, y, width, height, data);
+}
+
+//------------------------------------------------------------------------------
+// Get the color of a pixel
+//------------------------------------------------------------------------------
+int32_t IO_display_get_pixel(IO_io *io, uint16_t x, uint16_t y,
+  uint32_t *argb)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_get_pixel(&display0, x, y, argb);
+}
+
+//------------------------------------------------------------------------------
+// Get direct access to the framebuffer
+//------------------------------------------------------------------------------
+int32_t IO_display_get_framebuffer(IO_io *io, IO_framebuffer *fb)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_get_framebuffer(&display0, fb);
+}
+
+//------------------------------------------------------------------------------
+// Report a rectangle of the framebuffer as modified
+//------------------------------------------------------------------------------
+int32_t IO_display_mark_dirty(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_mark_dirty(&display0, x, y, width, height);
+}
+
+//------------------------------------------------------------------------------
+// Print bitmap
+//------------------------------------------------------------------------------
+int32_t IO_display_print_bitmap(IO_io *io, uint16_t x, uint16_t y,
+  const IO_bitmap *bitmap)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_blit_masked(&display0, x, y, bitmap, 0);
+}
+
+//------------------------------------------------------------------------------
+// Print bitmap through a mask
+//------------------------------------------------------------------------------
+int32_t IO_display_blit_masked(IO_io *io, uint16_t x, uint16_t y,
+  const IO_bitmap *bitmap, const IO_bitmap *mask)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_blit_masked(&display0, x, y, bitmap, mask);
+}
+
+//------------------------------------------------------------------------------
+// Fill a rectangle with ink
+//------------------------------------------------------------------------------
+int32_t IO_display_fill_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_fill_rect(&display0, x, y, width, height);
+}
+
+//------------------------------------------------------------------------------
+// Clear a rectangle to the background color
+//------------------------------------------------------------------------------
+int32_t IO_display_clear_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_clear_rect(&display0, x, y, width, height);
+}
+
+//------------------------------------------------------------------------------
+// Invert all the pixels in a rectangle
+//------------------------------------------------------------------------------
+int32_t IO_display_invert_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_invert_rect(&display0, x, y, width, height);
+}
+
+//------------------------------------------------------------------------------
+// Draw a horizontal line
+//------------------------------------------------------------------------------
+int32_t IO_display_hline(IO_io *io, uint16_t x, uint16_t y, uint16_t length)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_hline(&display0, x, y, length);
+}
+
+//------------------------------------------------------------------------------
+// Draw a vertical line
+//------------------------------------------------------------------------------
+int32_t IO_display_vline(IO_io *io, uint16_t x, uint16_t y, uint16_t length)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_vline(&display0, x, y, length);
+}
+
+//------------------------------------------------------------------------------
+// Copy a rectangle to another place on the screen
+//------------------------------------------------------------------------------
+int32_t IO_display_copy_rect(IO_io *io, uint16_t x, uint16_t y,
+  uint16_t width, uint16_t height, uint16_t to_x, uint16_t to_y)
+{
+  if(io->type != IO_DISPLAY || io->channel != 0)
+    return -IO_EINVAL;
+
+  return PCD8544_copy_rect(&display0, x, y, width, height, to_x, to_y);
+}
+
 //------------------------------------------------------------------------------
 // Get number of display devices available
 //------------------------------------------------------------------------------
@@ -175,6 +331,8 @@ static int32_t dac_write(IO_io *io, const void *data, uint32_t length)
   return 1;
 }
 
+static const IO_ops dac_ops = { dac_write, 0, 0, 0, 0, 0 };
+
 
 //------------------------------------------------------------------------------
 // Initialize a DAC
@@ -198,11 +356,9 @@ int32_t IO_dac_init(IO_io *io, uint8_t module)
   dac_data = (uint32_t*)addr;
 
   io->type    = IO_DAC;
-  io->sync    = 0;
+  io->ops     = &dac_ops;
   io->channel = 0;
   io->flags   = 0;
-  io->read    = 0;
-  io->write   = dac_write;
   io->event   = 0;
 
   return 0;
@@ -213,7 +369,6 @@ int32_t IO_dac_init(IO_io *io, uint8_t module)
 //------------------------------------------------------------------------------
 static IO_io snd_timer;
 static IO_io snd_dac;
-uint64_t     snd_interval = 0;
 uint8_t      snd_step = 0;
 
 // Found in EdX Embedded Systems Course materials
@@ -228,8 +383,6 @@ static void snd_timer_event(IO_io *io, uint16_t event)
 {
   IO_set(&snd_dac, snd_trumpet[snd_step++]);
   snd_step %= 32;
-  if(snd_interval)
-    IO_set(io, snd_interval);
 }
 
 //------------------------------------------------------------------------------
@@ -244,24 +397,16 @@ static int32_t snd_write(IO_io *io, const void *data, uint32_t length)
     return -IO_EINVAL;
   const uint64_t *val = data;
 
-  if(!(*val)) {
-    snd_interval = 0;
-    return 1;
-  }
-  uint8_t turn_on = 0;
-  if(!snd_interval)
-    turn_on = 1;
-
-  double interval = 1.0/(*val);
-  interval /= 32.0;
-  interval *= 1000000000;
-  snd_interval = interval;
-
-  if(turn_on)
-    IO_set(&snd_timer, interval);
-  return 1;
+  // 32 samples per period, in nanoseconds; the sample clock is a periodic
+  // timer, a new tone starts at the next sample
+  uint32_t interval = 0;
+  if(*val && *val <= 31250000)
+    interval = 31250000 / (uint32_t)(*val);
+  return IO_set(&snd_timer, interval);
 }
 
+static const IO_ops snd_ops = { snd_write, 0, 0, 0, 0, 0 };
+
 //------------------------------------------------------------------------------
 // Initialize a sound device
 //------------------------------------------------------------------------------
@@ -271,16 +416,14 @@ int32_t IO_sound_init(IO_io *io, uint8_t module)
     return -IO_EINVAL;
 
   IO_dac_init(&snd_dac, 0);
-  TM4C_timer_init(&snd_timer, 10);
+  TM4C_timer_init_periodic(&snd_timer, 10, 0);
   TM4C_enable_interrupt(102, 0); // adjust the interrupt priority for timer 10
   snd_timer.event = snd_timer_event;
 
   io->type    = IO_SOUND;
-  io->sync    = 0;
+  io->ops     = &snd_ops;
   io->channel = 0;
   io->flags   = 0;
-  io->read    = 0;
-  io->write   = snd_write;
   io->event   = 0;
 
   return 0;
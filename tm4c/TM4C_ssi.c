@@ -19,6 +19,7 @@
 
 #include <io/IO_device.h>
 #include <io/IO_error.h>
+#include <io/IO_sys.h>
 #include "TM4C.h"
 #include "TM4C_dma.h"
 #include "TM4C_gpio.h"
@@ -47,9 +48,33 @@ static const struct ssi_data ssi_info[] = {
 };
 
 //------------------------------------------------------------------------------
-// IO devices
+// Threads waiting for the FIFOs; mask holds the interrupts the waiter has
+// armed, user the ones enabled as events
 //------------------------------------------------------------------------------
-static struct IO_io *ssi_devices[4];
+struct ssi_waiter {
+  IO_sys_completion done;
+  volatile uint32_t mask;
+  uint32_t          user;
+};
+
+static struct ssi_waiter ssi_waiters[4];
+
+//------------------------------------------------------------------------------
+// Arm the interrupts in im and sleep until one of them fires; returns 0 if
+// the caller cannot sleep and needs to poll the status instead
+//------------------------------------------------------------------------------
+static int ssi_sleep(uint8_t module, uint32_t im)
+{
+  if(!IO_sys_can_block())
+    return 0;
+
+  uint32_t ssi_offset = module*SSI_MODULE_OFFSET;
+  IO_disable_interrupts();
+  ssi_waiters[module].mask = im;
+  SSI_REG(ssi_offset, SSI_IM) |= im;
+  IO_sys_completion_wait(&ssi_waiters[module].done);
+  return 1;
+}
 
 //------------------------------------------------------------------------------
 // Handle uart interrupt
@@ -58,9 +83,25 @@ static void ssi_handler(uint8_t module)
 {
   uint16_t events = 0;
   uint32_t module_offset = module * SSI_MODULE_OFFSET;
+  uint32_t mis = SSI_REG(module_offset, SSI_MIS);
+  struct ssi_waiter *waiter = &ssi_waiters[module];
+
+  //----------------------------------------------------------------------------
+  // Wake up the waiting thread; the FIFO interrupts are level-triggered, so
+  // we mask the ones that the user has not asked for
+  //----------------------------------------------------------------------------
+  if(mis & 0x02)
+    SSI_REG(module_offset, SSI_ICR) = 0x02;
+
+  if(mis & waiter->mask) {
+    SSI_REG(module_offset, SSI_IM) &= ~(waiter->mask & ~waiter->user);
+    waiter->mask = 0;
+    IO_sys_complete(&waiter->done);
+  }
 
-  if(SSI_REG(module_offset, SSI_MIS) & 0x04) events |= IO_EVENT_READ;
-  if(SSI_REG(module_offset, SSI_MIS) & 0x08) events |= IO_EVENT_WRITE;
+  mis &= waiter->user;
+  if(mis & 0x04) events |= IO_EVENT_READ;
+  if(mis & 0x08) events |= IO_EVENT_WRITE;
 
   //----------------------------------------------------------------------------
   // No known events but we have still been called. Check if we got a DMA
@@ -81,8 +122,7 @@ static void ssi_handler(uint8_t module)
   //----------------------------------------------------------------------------
   // Call the user handler
   //----------------------------------------------------------------------------
-  if(ssi_devices[module] && ssi_devices[module]->event)
-    ssi_devices[module]->event(ssi_devices[module], events);
+  TM4C_device_dispatch(TM4C_DEV_SSI + module, events);
 }
 
 //------------------------------------------------------------------------------
@@ -94,34 +134,51 @@ void ssi2_handler() { ssi_handler(2); }
 void ssi3_handler() { ssi_handler(3); }
 
 //------------------------------------------------------------------------------
-// Write to given SSI
+// Write a list of buffers to given SSI
 //------------------------------------------------------------------------------
-static int32_t ssi_write_normal(IO_io *io, const void *data, uint32_t length)
+static int32_t ssi_writev_normal(IO_io *io, const IO_iovec *iov, uint32_t num)
 {
   uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
   uint8_t byte = 1;
   if((SSI_REG(ssi_offset, SSI_CR0) & 0x0f) > 7)
     byte = 0;
-  const uint8_t  *b_data8  = data;
-  const uint16_t *b_data16 = data;
-
-  for(uint32_t i = 0; i < length; ++i) {
-    // we cannot write if TNF is 0
-    if(io->flags & IO_NONBLOCKING) {
-      if((SSI_REG(ssi_offset, SSI_SR) & 0x02) == 0) {
-        if(i == 0) return -IO_EWOULDBLOCK;
-        else return i;
+  uint32_t written = 0;
+
+  for(uint32_t j = 0; j < num; ++j) {
+    const uint8_t  *b_data8  = iov[j].base;
+    const uint16_t *b_data16 = iov[j].base;
+
+    for(uint32_t i = 0; i < iov[j].length; ++i) {
+      // we cannot write if TNF is 0
+      if(io->flags & IO_NONBLOCKING) {
+        if((SSI_REG(ssi_offset, SSI_SR) & 0x02) == 0) {
+          if(written == 0) return -IO_EWOULDBLOCK;
+          else return written;
+        }
       }
+      else
+        // the FIFO drains in microseconds, less than a round trip through
+        // the scheduler, and the TX interrupt only fires once the line is
+        // idle (EOT), so we spin
+        while((SSI_REG(ssi_offset, SSI_SR) & 0x02) == 0);
+
+      if(byte)
+        SSI_REG(ssi_offset, SSI_DR) = b_data8[i];
+      else
+        SSI_REG(ssi_offset, SSI_DR) = b_data16[i];
+      ++written;
     }
-    else
-      while((SSI_REG(ssi_offset, SSI_SR) & 0x02) == 0);
-
-    if(byte)
-      SSI_REG(ssi_offset, SSI_DR) = b_data8[i];
-    else
-      SSI_REG(ssi_offset, SSI_DR) = b_data16[i];
   }
-  return length;
+  return written;
+}
+
+//------------------------------------------------------------------------------
+// Write to given SSI
+//------------------------------------------------------------------------------
+static int32_t ssi_write_normal(IO_io *io, const void *data, uint32_t length)
+{
+  IO_iovec iov = {data, length};
+  return ssi_writev_normal(io, &iov, 1);
 }
 
 //------------------------------------------------------------------------------
@@ -145,7 +202,8 @@ static int32_t ssi_read_normal(IO_io *io, void *data, uint32_t length)
       }
     }
     else
-      while((SSI_REG(ssi_offset, SSI_SR) & 0x04) == 0);
+      while((SSI_REG(ssi_offset, SSI_SR) & 0x04) == 0)
+        ssi_sleep(io->channel, 0x06);  // RX or receive time-out
 
     if(byte)
       b_data8[i] = SSI_REG(ssi_offset, SSI_DR) & 0xff;
@@ -163,53 +221,61 @@ static int32_t ssi_write_dma(IO_io *io, const void *data, uint32_t length)
   uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
   uint8_t dma_channel = ssi_info[io->channel].dma_channel_tx;
   uint8_t dma_enc = ssi_info[io->channel].dma_channel_enc;
-  dma_control *ctrl = TM4C_dma_get_control(dma_channel, DMA_TYPE_PRIMARY);
 
   //----------------------------------------------------------------------------
-  // Check whether the DMA channel is ready for a transfer
+  // Wait for a free slot in the queue of the DMA channel
   //----------------------------------------------------------------------------
-  if(io->flags & IO_NONBLOCKING) {
-    if(ctrl->control & 0x03)
-      return -IO_EWOULDBLOCK;
-  }
-  else
-    while(ctrl->control & 0x03);
+  int32_t ret = TM4C_dma_wait_queue(dma_channel, DMA_MAX_IN_FLIGHT-1,
+                                    io->flags & IO_NONBLOCKING);
+  if(ret)
+    return ret;
 
   //----------------------------------------------------------------------------
-  // Set the channel control up
+  // Set the transfer up; it starts as soon as the previous ones are done and
+  // long buffers are split into scatter-gather tasks
   //----------------------------------------------------------------------------
   if(length == 0)
     return 0;
 
-  if(length > 1024)
-    length = 1024;
+  uint32_t control = 0;
+  if((SSI_REG(ssi_offset, SSI_CR0) & 0x0f) > 7) {
+    control |= (0x01 << 28);    // destination item size is a half-word
+    control |= (0x01 << 26);    // source increments by a half-word
+    control |= (0x01 << 24);    // source item data size is a half-word
+  }
+  control |= (0x03 << 30);      // destination does not increment
+  control |= (0x02 << 14);      // arbitration size is 4 transfers ==
+                                // interrupt trigger level for FIFO
 
-  uint8_t byte = 1;
-  if((SSI_REG(ssi_offset, SSI_CR0) & 0x0f) > 7)
-    byte = 0;
+  return TM4C_dma_transfer(dma_channel, dma_enc, data,
+                           (void *)&SSI_REG(ssi_offset, SSI_DR), control,
+                           length);
+}
 
-  if(byte)
-    ctrl->src = ((uint8_t *)data)+(length-1); // last item of the buffer
-  else {
-    ctrl->src = ((uint16_t *)data)+(length-1); // last item of the buffer
-    ctrl->control |= (0x01 << 28);             // destination item size is
-                                               // a half-word
-    ctrl->control |= (0x01 << 26);             // source increments by a
-                                               // half-word
-    ctrl->control |= (0x01 << 24);             // source item data size is
-                                               // a half-word
-  }
+//------------------------------------------------------------------------------
+// Gather a list of buffers to SSI in one DMA chain
+//------------------------------------------------------------------------------
+static int32_t ssi_writev_dma(IO_io *io, const IO_iovec *iov, uint32_t num)
+{
+  uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
+  uint8_t dma_channel = ssi_info[io->channel].dma_channel_tx;
+  uint8_t dma_enc = ssi_info[io->channel].dma_channel_enc;
 
-  ctrl->dst = (void *)&SSI_REG(ssi_offset, SSI_DR);
-  ctrl->control = 0;
-  ctrl->control |= (0x03 << 30);      // destination does not increment
-  ctrl->control |= (0x02 << 14);      // arbitration size is 4 transfers ==
-                                      // interrupt trigger level for FIFO
-  ctrl->control |= ((length-1) << 4); // transfer size, up to 1024 items
-  ctrl->control |= 0x01;              // basic transfer mode
+  int32_t ret = TM4C_dma_wait(dma_channel, io->flags & IO_NONBLOCKING);
+  if(ret)
+    return ret;
 
-  TM4C_dma_run_transfer(dma_channel, dma_enc);
-  return length;
+  uint32_t control = 0;
+  if((SSI_REG(ssi_offset, SSI_CR0) & 0x0f) > 7) {
+    control |= (0x01 << 28);    // destination item size is a half-word
+    control |= (0x01 << 26);    // source increments by a half-word
+    control |= (0x01 << 24);    // source item data size is a half-word
+  }
+  control |= (0x03 << 30);      // destination does not increment
+  control |= (0x02 << 14);      // arbitration size is 4 transfers
+
+  return TM4C_dma_gather(dma_channel, dma_enc, iov, num,
+                         (void *)&SSI_REG(ssi_offset, SSI_DR), control);
 }
 
 //------------------------------------------------------------------------------
@@ -220,52 +286,35 @@ static int32_t ssi_read_dma(IO_io *io, void *data, uint32_t length)
   uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
   uint8_t dma_channel = ssi_info[io->channel].dma_channel_rx;
   uint8_t dma_enc = ssi_info[io->channel].dma_channel_enc;
-  dma_control *ctrl = TM4C_dma_get_control(dma_channel, DMA_TYPE_PRIMARY);
 
   //----------------------------------------------------------------------------
-  // Check whether the DMA channel is ready for a transfer
+  // Wait for a free slot in the queue of the DMA channel
   //----------------------------------------------------------------------------
-  if(io->flags & IO_NONBLOCKING) {
-    if(ctrl->control & 0x03)
-      return -IO_EWOULDBLOCK;
-  }
-  else
-    while(ctrl->control & 0x03);
+  int32_t ret = TM4C_dma_wait_queue(dma_channel, DMA_MAX_IN_FLIGHT-1,
+                                    io->flags & IO_NONBLOCKING);
+  if(ret)
+    return ret;
 
   //----------------------------------------------------------------------------
-  // Set the channel control up
+  // Set the transfer up; it starts as soon as the previous ones are done and
+  // long buffers are split into scatter-gather tasks
   //----------------------------------------------------------------------------
   if(length == 0)
     return 0;
 
-  if(length > 1024)
-    length = 1024;
-
-  uint8_t byte = 1;
-  if((SSI_REG(ssi_offset, SSI_CR0) & 0x0f) > 7)
-    byte = 0;
-
-  ctrl->control = 0;
-  ctrl->src = (void *)&SSI_REG(ssi_offset, SSI_DR);
-  if(byte)
-    ctrl->dst = ((uint8_t *)data)+(length-1); // last byte of the buffer
-  else {
-    ctrl->dst = ((uint16_t *)data)+(length-1); // last item of the buffer
-    ctrl->control |= (0x01 << 30);             // destination increments by a
-                                               // half-word
-    ctrl->control |= (0x01 << 28);             // destination item size is
-                                               // a half-word
-    ctrl->control |= (0x01 << 24);             // source item data size is
-                                               // a half-word
+  uint32_t control = 0;
+  if((SSI_REG(ssi_offset, SSI_CR0) & 0x0f) > 7) {
+    control |= (0x01 << 30);    // destination increments by a half-word
+    control |= (0x01 << 28);    // destination item size is a half-word
+    control |= (0x01 << 24);    // source item data size is a half-word
   }
-  ctrl->control |= (0x03 << 26);      // source does not increment
-  ctrl->control |= (0x02 << 14);      // arbitration size is 4 transfers ==
-                                      // interrupt trigger level for FIFO
-  ctrl->control |= ((length-1) << 4); // transfer size, up to 1024 items
-  ctrl->control |= 0x01;              // basic transfer mode
+  control |= (0x03 << 26);      // source does not increment
+  control |= (0x02 << 14);      // arbitration size is 4 transfers ==
+                                // interrupt trigger level for FIFO
 
-  TM4C_dma_run_transfer(dma_channel, dma_enc);
-  return length;
+  return TM4C_dma_transfer(dma_channel, dma_enc,
+                           (void *)&SSI_REG(ssi_offset, SSI_DR), data,
+                           control, length);
 }
 
 //------------------------------------------------------------------------------
@@ -274,19 +323,75 @@ static int32_t ssi_read_dma(IO_io *io, void *data, uint32_t length)
 static int32_t ssi_sync(IO_io *io)
 {
   uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
-  // the busy bit is set untill the last byte from the TX FIFO has been
-  // transmitted
-  while(SSI_REG(ssi_offset, SSI_SR) & 0x10);
+
+  //----------------------------------------------------------------------------
+  // The DMA needs to move everything it has queued to the FIFO first
+  //----------------------------------------------------------------------------
+  if(io->flags & IO_DMA)
+    TM4C_dma_wait(ssi_info[io->channel].dma_channel_tx, 0);
+
+  //----------------------------------------------------------------------------
+  // The busy bit is set untill the last byte from the TX FIFO has been
+  // transmitted; in master mode, the TX interrupt fires at the end of
+  // transmission, so we can sleep until then
+  //----------------------------------------------------------------------------
+  uint8_t eot = !(SSI_REG(ssi_offset, SSI_CR1) & 0x04);
+  while(SSI_REG(ssi_offset, SSI_SR) & 0x10)
+    if(eot)
+      ssi_sleep(io->channel, 0x08);
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Enable events on SSI device
+//------------------------------------------------------------------------------
+static int32_t ssi_event_enable(IO_io *io, uint16_t events)
+{
+  uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
+  uint32_t im = 0;
+  if(events & IO_EVENT_READ)  im |= 0x04;
+  if(events & IO_EVENT_WRITE) im |= 0x08;
+  IO_disable_interrupts();
+  ssi_waiters[io->channel].user |= im;
+  SSI_REG(ssi_offset, SSI_IM) |= im;
+  IO_enable_interrupts();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Disable events on SSI device
+//------------------------------------------------------------------------------
+static int32_t ssi_event_disable(IO_io *io, uint16_t events)
+{
+  uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
+  uint32_t im = 0;
+  if(events & IO_EVENT_READ)  im |= 0x04;
+  if(events & IO_EVENT_WRITE) im |= 0x08;
+  IO_disable_interrupts();
+  ssi_waiters[io->channel].user &= ~im;
+  SSI_REG(ssi_offset, SSI_IM) &= ~(im & ~ssi_waiters[io->channel].mask);
+  IO_enable_interrupts();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Device operations
+//------------------------------------------------------------------------------
+static const IO_ops ssi_ops_normal = {
+  ssi_write_normal, ssi_writev_normal, ssi_read_normal, ssi_sync,
+  ssi_event_enable, ssi_event_disable };
+
+static const IO_ops ssi_ops_dma = {
+  ssi_write_dma, ssi_writev_dma, ssi_read_dma, ssi_sync,
+  ssi_event_enable, ssi_event_disable };
+
 //------------------------------------------------------------------------------
 // Initialize given SSI module
 //------------------------------------------------------------------------------
 int32_t IO_ssi_init(IO_io *io, uint8_t module, uint16_t flags,
   IO_ssi_attrs *attrs)
 {
-  if(module > 7)
+  if(module > 3)
     return -IO_EINVAL;
 
   if(!io)
@@ -348,6 +453,8 @@ int32_t IO_ssi_init(IO_io *io, uint8_t module, uint16_t flags,
   // master/slave?
   if(attrs->master) {
     SSI_REG(ssi_offset, SSI_CR1) &= ~0x04;
+    // the TX interrupt signals the end of transmission
+    SSI_REG(ssi_offset, SSI_CR1) |= 0x10;
     // clock
     SSI_REG(ssi_offset, SSI_CPSR)  = prescale & 0xff;
     SSI_REG(ssi_offset, SSI_CR0)  &= ~(0xff << 8);
@@ -355,6 +462,7 @@ int32_t IO_ssi_init(IO_io *io, uint8_t module, uint16_t flags,
   }
   else {
     SSI_REG(ssi_offset, SSI_CR1) |= 0x04;
+    SSI_REG(ssi_offset, SSI_CR1) &= ~0x10;
 
     // slave output
     if(attrs->slave_out)
@@ -389,8 +497,13 @@ int32_t IO_ssi_init(IO_io *io, uint8_t module, uint16_t flags,
   SSI_REG(ssi_offset, SSI_CR0) &= ~0x0f;
   SSI_REG(ssi_offset, SSI_CR0) |= ((attrs->frame_size-1) & 0x0f);
 
-  if(flags & IO_DMA)
+  if(flags & IO_DMA) {
+    uint8_t enc = ssi_info[module].dma_channel_enc;
+    if(TM4C_dma_channel_alloc(ssi_info[module].dma_channel_rx, enc, 0, 0) ||
+       TM4C_dma_channel_alloc(ssi_info[module].dma_channel_tx, enc, 0, 0))
+      return -IO_EBUSY;
     SSI_REG(ssi_offset, SSI_DMACTL) |= 0x03;
+  }
 
   // remove the garbage from the incoming queue
   uint8_t byte;
@@ -408,48 +521,17 @@ int32_t IO_ssi_init(IO_io *io, uint8_t module, uint16_t flags,
   io->flags = flags;
   io->type = IO_SSI;
   io->event = 0;
-  io->sync = ssi_sync;
-  ssi_devices[module] = io;
-
-  //----------------------------------------------------------------------------
-  // Normal read/write
-  //----------------------------------------------------------------------------
-  if(!(flags & IO_DMA)) {
-    io->write = ssi_write_normal;
-    io->read = ssi_read_normal;
-  }
-  else {
-    io->write = ssi_write_dma;
-    io->read = ssi_read_dma;
-  }
+  io->ops = flags & IO_DMA ? &ssi_ops_dma : &ssi_ops_normal;
+  TM4C_device_register(TM4C_DEV_SSI + module, io);
+  ssi_waiters[module].mask = 0;
+  ssi_waiters[module].user = 0;
+  IO_sys_completion_init(&ssi_waiters[module].done);
 
   //----------------------------------------------------------------------------
-  // Enable the interrupt if needed
+  // Enable the interrupt; it is needed for the events, the DMA completions
+  // and to wake up the blocked threads
   //----------------------------------------------------------------------------
-  if(flags & IO_ASYNC)
-    TM4C_enable_interrupt(ssi_info[module].interrupt_num, 7);
-
-  return 0;
-}
+  TM4C_enable_interrupt(ssi_info[module].interrupt_num, 7);
 
-//------------------------------------------------------------------------------
-// Enable events on SSI device
-//------------------------------------------------------------------------------
-int32_t TM4C_ssi_event_enable(IO_io *io, uint16_t events)
-{
-  uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
-  if(events & IO_EVENT_READ)  SSI_REG(ssi_offset, SSI_IM) |= 0x04;
-  if(events & IO_EVENT_WRITE) SSI_REG(ssi_offset, SSI_IM) |= 0x08;
-  return 0;
-}
-
-//------------------------------------------------------------------------------
-// Disable events on SSI device
-//------------------------------------------------------------------------------
-int32_t TM4C_ssi_event_disable(IO_io *io, uint16_t events)
-{
-  uint32_t ssi_offset = io->channel*SSI_MODULE_OFFSET;
-  if(events & IO_EVENT_READ)  SSI_REG(ssi_offset, SSI_IM) &= ~0x08;
-  if(events & IO_EVENT_WRITE) SSI_REG(ssi_offset, SSI_IM) &= ~0x04;
   return 0;
 }
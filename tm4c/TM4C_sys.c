@@ -39,6 +39,25 @@ void IO_disable_interrupts()
   __asm__ volatile("cpsid i");
 }
 
+//------------------------------------------------------------------------------
+// Save PRIMASK and disable interrupts
+//------------------------------------------------------------------------------
+uint32_t IO_save_interrupts()
+{
+  uint32_t state;
+  __asm__ volatile("mrs %0, primask\r\n"
+                   "cpsid i" : "=r" (state) :: "memory");
+  return state;
+}
+
+//------------------------------------------------------------------------------
+// Restore PRIMASK
+//------------------------------------------------------------------------------
+void IO_restore_interrupts(uint32_t state)
+{
+  __asm__ volatile("msr primask, %0" :: "r" (state) : "memory");
+}
+
 //------------------------------------------------------------------------------
 // Wait for an interrupt
 //------------------------------------------------------------------------------
@@ -47,6 +66,17 @@ void IO_wait_for_interrupt()
   __asm__ volatile("wfi");
 }
 
+//------------------------------------------------------------------------------
+// Check whether we run in an interrupt handler - IPSR holds the number of
+// the active exception
+//------------------------------------------------------------------------------
+int IO_sys_in_interrupt()
+{
+  uint32_t ipsr;
+  __asm__ volatile("mrs %0, ipsr" : "=r" (ipsr));
+  return (ipsr & 0x1ff) != 0;
+}
+
 //------------------------------------------------------------------------------
 // Set up the stack and launch the thread - implemented in assembly
 //------------------------------------------------------------------------------
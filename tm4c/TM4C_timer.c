@@ -29,17 +29,16 @@
 static const int timer_interrupt[12] = {
   19, 21, 23, 35, 70, 92, 94, 96, 98, 100, 102, 104};
 
-static struct IO_io *timer_devices[12];
-
 //------------------------------------------------------------------------------
 // Handle interrupts
 //------------------------------------------------------------------------------
 static void timer_handler(uint8_t module)
 {
+  // ack the interrupt first, the handler may re-arm the timer for a time-out
+  // that comes before it returns
   int module_offset = module * GPTM_MODULE_OFFSET;
-  if(timer_devices[module] && timer_devices[module]->event)
-    timer_devices[module]->event(timer_devices[module], IO_EVENT_TICK);
-  GPTM_REG(module_offset, GPTM_ICR) |= 1; // ack the interrupt
+  GPTM_REG(module_offset, GPTM_ICR) |= 1;
+  TM4C_device_dispatch(TM4C_DEV_TIMER + module, IO_EVENT_TICK);
 }
 
 void timer0a_32_handler() { timer_handler(0); }
@@ -56,10 +55,14 @@ void timer4a_64_handler() { timer_handler(10); }
 void timer5a_64_handler() { timer_handler(11); }
 
 //------------------------------------------------------------------------------
-// Convert nanoseconds to the clock ticks, in our case 12.5 ns/tick (80MHz)
+// Convert nanoseconds to the clock ticks, in our case 12.5 ns/tick (80MHz);
+// the time-outs below two seconds take the hardware 32-bit division instead
+// of the 64-bit library call
 //------------------------------------------------------------------------------
 static uint64_t nsecs2ticks(uint64_t ns)
 {
+  if(ns <= 0x7fffffff)
+    return ((uint32_t)ns << 1) / 25;
   ns <<= 1;
   return  ns/25;
 }
@@ -152,6 +155,59 @@ static int32_t timer64_read(IO_io *io, void *data, uint32_t length)
   return 1;
 }
 
+//------------------------------------------------------------------------------
+// Set the period of a periodic timer; the counter runs from the reload value
+// down to zero, so the reload is one tick shorter than the period
+//------------------------------------------------------------------------------
+static int32_t timer_periodic_write(IO_io *io, const void *data,
+  uint32_t length)
+{
+  if(length != 1)
+    return -IO_EINVAL;
+
+  uint64_t val = nsecs2ticks(*(const uint64_t*)data);
+  int module_offset = io->channel * GPTM_MODULE_OFFSET;
+  if(!val) {
+    GPTM_REG(module_offset, GPTM_CTL) &= ~1;
+    return 1;
+  }
+
+  --val;
+  if(io->channel <= 5 && val > 0xffffffff)
+    return -IO_EINVAL;
+
+  // a running timer picks up the new reload value at the next time-out, so
+  // the current period is not cut short; a stopped one needs the counter
+  // loaded as well
+  GPTM_REG(module_offset, GPTM_TAILR) = (uint32_t)val;
+  if(io->channel > 5)
+    GPTM_REG(module_offset, GPTM_TBILR) = (uint32_t)(val >> 32);
+
+  if(!(GPTM_REG(module_offset, GPTM_CTL) & 1)) {
+    GPTM_REG(module_offset, GPTM_TAV) = (uint32_t)val;
+    if(io->channel > 5)
+      GPTM_REG(module_offset, GPTM_TBV) = (uint32_t)(val >> 32);
+    GPTM_REG(module_offset, GPTM_CTL) |= 1;
+  }
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// Read the period of a periodic timer
+//------------------------------------------------------------------------------
+static int32_t timer_periodic_read(IO_io *io, void *data, uint32_t length)
+{
+  if(length != 1)
+    return -IO_EINVAL;
+
+  int module_offset = io->channel * GPTM_MODULE_OFFSET;
+  uint64_t val = GPTM_REG(module_offset, GPTM_TAILR);
+  if(io->channel > 5)
+    val |= (uint64_t)GPTM_REG(module_offset, GPTM_TBILR) << 32;
+  *(uint64_t *)data = ticks2nsecs(val + 1);
+  return 1;
+}
+
 //------------------------------------------------------------------------------
 // Sync timer
 //------------------------------------------------------------------------------
@@ -161,11 +217,24 @@ static int32_t timer_sync(IO_io *io)
 }
 
 //------------------------------------------------------------------------------
-// Initialize a timer
+// Device operations
+//------------------------------------------------------------------------------
+static const IO_ops timer32_ops = {
+  timer32_write, 0, timer32_read, timer_sync, 0, 0 };
+
+static const IO_ops timer64_ops = {
+  timer64_write, 0, timer64_read, timer_sync, 0, 0 };
+
+static const IO_ops timer_periodic_ops = {
+  timer_periodic_write, 0, timer_periodic_read, timer_sync, 0, 0 };
+
+//------------------------------------------------------------------------------
+// Initialize a timer; timer 9 runs the clock and timer 11 runs the software
+// timers
 //------------------------------------------------------------------------------
 int32_t IO_timer_init(IO_io *io, uint8_t module)
 {
-  if(module > 10)
+  if(module > 10 || module == 9)
     return -IO_EINVAL;
   return TM4C_timer_init(io, module);
 }
@@ -209,17 +278,109 @@ int32_t TM4C_timer_init(IO_io *io, uint8_t module)
   io->type    = IO_TIMER;
   io->flags   = IO_ASYNC;
   io->event   = 0;
-  io->sync    = timer_sync;
+  io->ops     = module <= 5 ? &timer32_ops : &timer64_ops;
+  TM4C_device_register(TM4C_DEV_TIMER + module, io);
 
-  if(module <= 5) {
-    io->read    = timer32_read;
-    io->write   = timer32_write;
-  }
-  else {
-    io->read    = timer64_read;
-    io->write   = timer64_write;
-  }
-  timer_devices[module] = io;
+  return 0;
+}
 
+//------------------------------------------------------------------------------
+// Initialize a periodic timer
+//------------------------------------------------------------------------------
+int32_t IO_timer_init_periodic(IO_io *io, uint8_t module, uint64_t period)
+{
+  if(module > 10 || module == 9)
+    return -IO_EINVAL;
+  return TM4C_timer_init_periodic(io, module, period);
+}
+
+//------------------------------------------------------------------------------
+// Initialize a periodic timer; the hardware reloads the counter, so the
+// handlers do not re-arm it and the period does not depend on their latency
+//------------------------------------------------------------------------------
+int32_t TM4C_timer_init_periodic(IO_io *io, uint8_t module, uint64_t period)
+{
+  int32_t ret = TM4C_timer_init(io, module);
+  if(ret)
+    return ret;
+
+  // periodic timer, update the reload value at the time-out
+  uint16_t module_offset = module * GPTM_MODULE_OFFSET;
+  GPTM_REG(module_offset, GPTM_TAMR) = 0x102;
+
+  io->ops = &timer_periodic_ops;
+
+  if(period && IO_set(io, period) != 1)
+    return -IO_EINVAL;
   return 0;
 }
+
+//------------------------------------------------------------------------------
+// Run the timer periodically to trigger the ADC; the timer does not interrupt
+// and cannot be used as an IO device at the same time
+//------------------------------------------------------------------------------
+int32_t TM4C_timer_adc_trigger(uint8_t module, uint64_t period)
+{
+  if(module > 11)
+    return -IO_EINVAL;
+
+  uint64_t val = nsecs2ticks(period);
+  if(!val || (module <= 5 && val > 0xffffffff))
+    return -IO_EINVAL;
+
+  uint16_t module_offset = module * GPTM_MODULE_OFFSET;
+
+  if(module <= 5)
+    RCGCTIMER_REG |= (1 << module);
+  else
+    RCGCWTIMER_REG |= (1 << (module-6));
+
+  GPTM_REG(module_offset, GPTM_CTL)   &= ~1;
+  GPTM_REG(module_offset, GPTM_CFG)    = 0;
+  GPTM_REG(module_offset, GPTM_TAMR)   = 0x02; // periodic
+  GPTM_REG(module_offset, GPTM_IMR)    = 0;
+  GPTM_REG(module_offset, GPTM_TAILR)  = (uint32_t)val;
+  if(module > 5)
+    GPTM_REG(module_offset, GPTM_TBILR) = (uint32_t)(val >> 32);
+
+  // ADC trigger output and enable
+  GPTM_REG(module_offset, GPTM_CTL) |= 0x21;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Run a wide timer as a free-running 64-bit counter; at 80MHz it does not
+// wrap around for thousands of years
+//------------------------------------------------------------------------------
+int32_t TM4C_timer_counter_init(uint8_t module)
+{
+  if(module < 6 || module > 11)
+    return -IO_EINVAL;
+
+  uint16_t module_offset = module * GPTM_MODULE_OFFSET;
+  RCGCWTIMER_REG |= (1 << (module-6));
+
+  GPTM_REG(module_offset, GPTM_CTL)   &= ~1;
+  GPTM_REG(module_offset, GPTM_CFG)    = 0;
+  GPTM_REG(module_offset, GPTM_TAMR)   = 0x12; // periodic, counting up
+  GPTM_REG(module_offset, GPTM_IMR)    = 0;
+  GPTM_REG(module_offset, GPTM_TAILR)  = 0xffffffff;
+  GPTM_REG(module_offset, GPTM_TBILR)  = 0xffffffff;
+  GPTM_REG(module_offset, GPTM_CTL)   |= 1;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Read the free-running counter; the halves are separate registers, so we
+// read the upper one again to catch a carry in between
+//------------------------------------------------------------------------------
+uint64_t TM4C_timer_counter_read(uint8_t module)
+{
+  uint16_t module_offset = module * GPTM_MODULE_OFFSET;
+  uint32_t high, low;
+  do {
+    high = GPTM_REG(module_offset, GPTM_TBV);
+    low  = GPTM_REG(module_offset, GPTM_TAV);
+  } while(high != GPTM_REG(module_offset, GPTM_TBV));
+  return ((uint64_t)high << 32) | low;
+}
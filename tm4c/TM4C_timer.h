@@ -25,3 +25,23 @@
 // Initialize a timer
 //------------------------------------------------------------------------------
 int32_t TM4C_timer_init(IO_io *io, uint8_t module);
+
+//------------------------------------------------------------------------------
+// Initialize a periodic timer
+//------------------------------------------------------------------------------
+int32_t TM4C_timer_init_periodic(IO_io *io, uint8_t module, uint64_t period);
+
+//------------------------------------------------------------------------------
+// Run the timer periodically to trigger the ADC
+//------------------------------------------------------------------------------
+int32_t TM4C_timer_adc_trigger(uint8_t module, uint64_t period);
+
+//------------------------------------------------------------------------------
+// Run a wide timer as a free-running 64-bit counter of the system clock
+//------------------------------------------------------------------------------
+int32_t TM4C_timer_counter_init(uint8_t module);
+
+//------------------------------------------------------------------------------
+// Read the free-running counter
+//------------------------------------------------------------------------------
+uint64_t TM4C_timer_counter_read(uint8_t module);
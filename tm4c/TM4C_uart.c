@@ -19,10 +19,14 @@
 
 #include <io/IO_device.h>
 #include <io/IO_error.h>
+#include <io/IO_malloc.h>
+#include <io/IO_sys.h>
 #include "TM4C.h"
 #include "TM4C_dma.h"
 #include "TM4C_gpio.h"
 
+#include <string.h>
+
 //------------------------------------------------------------------------------
 // GPIO pins for UART
 //------------------------------------------------------------------------------
@@ -48,9 +52,117 @@ static const struct uart_data uart_info[] = {
 };
 
 //------------------------------------------------------------------------------
-// IO devices
+// Threads waiting for the FIFOs; mask holds the interrupts the waiter has
+// armed, user the ones enabled as events
 //------------------------------------------------------------------------------
-static struct IO_io *uart_devices[8];
+struct uart_waiter {
+  IO_sys_completion done;
+  volatile uint32_t mask;
+  uint32_t          user;
+};
+
+static struct uart_waiter uart_waiters[8];
+
+//------------------------------------------------------------------------------
+// Arm the interrupts in im and sleep until one of them fires; returns 0 if
+// the caller cannot sleep and needs to poll the status instead. The raw
+// status is latched, so whatever has happened since the caller checked the
+// flags fires as soon as we unmask it.
+//------------------------------------------------------------------------------
+static int uart_sleep(uint8_t module, uint32_t im)
+{
+  if(!IO_sys_can_block())
+    return 0;
+
+  uint32_t uart_offset = module*UART_MODULE_OFFSET;
+  IO_disable_interrupts();
+  uart_waiters[module].mask = im;
+  UART_REG(uart_offset, UART_IM) |= im;
+  IO_sys_completion_wait(&uart_waiters[module].done);
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// Ring buffers of the buffered mode
+//------------------------------------------------------------------------------
+#define UART_TX_BUFFER 128
+#define UART_RX_BUFFER 32
+
+struct uart_ring {
+  uint8_t          *data;
+  uint16_t          size;
+  volatile uint16_t head;     // where the next byte goes
+  volatile uint16_t tail;     // where the next byte comes from
+  volatile uint16_t count;    // number of bytes queued
+  IO_sys_completion done;     // a thread waits for the ring
+};
+
+struct uart_buffers {
+  struct uart_ring tx;
+  struct uart_ring rx;
+};
+
+static struct uart_buffers *uart_buffers[8];
+
+static void ring_push(struct uart_ring *ring, uint8_t byte)
+{
+  ring->data[ring->head] = byte;
+  if(++ring->head == ring->size)
+    ring->head = 0;
+  ++ring->count;
+}
+
+static uint8_t ring_pop(struct uart_ring *ring)
+{
+  uint8_t byte = ring->data[ring->tail];
+  if(++ring->tail == ring->size)
+    ring->tail = 0;
+  --ring->count;
+  return byte;
+}
+
+//------------------------------------------------------------------------------
+// Move the queued bytes to the TX FIFO; the interrupt fires when the FIFO
+// drains below the trigger level, so it is only needed while there is
+// something left in the ring
+//------------------------------------------------------------------------------
+static void uart_tx_fill(uint32_t uart_offset, struct uart_ring *tx)
+{
+  while(tx->count && !(UART_REG(uart_offset, UART_FR) & 0x20))
+    UART_REG(uart_offset, UART_DR) = ring_pop(tx);
+
+  if(tx->count)
+    UART_REG(uart_offset, UART_IM) |= 0x20;
+  else
+    UART_REG(uart_offset, UART_IM) &= ~0x20;
+
+  if(tx->count < tx->size)
+    IO_sys_complete(&tx->done);
+}
+
+//------------------------------------------------------------------------------
+// Handle the interrupt of a buffered uart
+//------------------------------------------------------------------------------
+static void uart_buffered_handler(uint8_t module)
+{
+  uint32_t uart_offset = module * UART_MODULE_OFFSET;
+  struct uart_buffers *buf = uart_buffers[module];
+
+  UART_REG(uart_offset, UART_ICR) = UART_REG(uart_offset, UART_MIS);
+
+  //----------------------------------------------------------------------------
+  // Empty the RX FIFO; drop what does not fit
+  //----------------------------------------------------------------------------
+  while(!(UART_REG(uart_offset, UART_FR) & 0x10)) {
+    uint8_t byte = UART_REG(uart_offset, UART_DR) & 0xff;
+    if(buf->rx.count < buf->rx.size)
+      ring_push(&buf->rx, byte);
+  }
+  if(buf->rx.count)
+    IO_sys_complete(&buf->rx.done);
+
+  uart_tx_fill(uart_offset, &buf->tx);
+}
 
 //------------------------------------------------------------------------------
 // Handle uart interrupt
@@ -60,8 +172,29 @@ static void uart_handler(uint8_t module)
   uint16_t events = 0;
   uint32_t module_offset = module * UART_MODULE_OFFSET;
 
-  if(UART_REG(module_offset, UART_MIS) & 0x10) events |= IO_EVENT_READ;
-  if(UART_REG(module_offset, UART_MIS) & 0x20) events |= IO_EVENT_WRITE;
+  IO_io *io = TM4C_device(TM4C_DEV_UART + module);
+  if(io && (io->flags & IO_BUFFERED)) {
+    uart_buffered_handler(module);
+    return;
+  }
+
+  uint32_t mis = UART_REG(module_offset, UART_MIS);
+  struct uart_waiter *waiter = &uart_waiters[module];
+
+  //----------------------------------------------------------------------------
+  // Wake up the waiting thread and mask the interrupts that the user has not
+  // asked for
+  //----------------------------------------------------------------------------
+  if(mis & waiter->mask) {
+    UART_REG(module_offset, UART_ICR) = mis & waiter->mask;
+    UART_REG(module_offset, UART_IM) &= ~(waiter->mask & ~waiter->user);
+    waiter->mask = 0;
+    IO_sys_complete(&waiter->done);
+  }
+
+  mis &= waiter->user;
+  if(mis & 0x10) events |= IO_EVENT_READ;
+  if(mis & 0x20) events |= IO_EVENT_WRITE;
 
   //----------------------------------------------------------------------------
   // No known events but we have still been called. Check if we got a DMA
@@ -82,8 +215,8 @@ static void uart_handler(uint8_t module)
   //----------------------------------------------------------------------------
   // Call the user handler
   //----------------------------------------------------------------------------
-  if(uart_devices[module] && uart_devices[module]->event)
-    uart_devices[module]->event(uart_devices[module], events);
+  if(io && io->event)
+    io->event(io, events);
 }
 
 //------------------------------------------------------------------------------
@@ -99,26 +232,40 @@ void uart6_handler() { uart_handler(6); }
 void uart7_handler() { uart_handler(7); }
 
 //------------------------------------------------------------------------------
-// Write to given UART
+// Write a list of buffers to given UART
 //------------------------------------------------------------------------------
-static int32_t uart_write_normal(IO_io *io, const void *data, uint32_t length)
+static int32_t uart_writev_normal(IO_io *io, const IO_iovec *iov, uint32_t num)
 {
   uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
-
-  const uint8_t *b_data = data;
-  for(uint32_t i = 0; i < length; ++i) {
-    // we cannot write if TXFF is 1
-    if(io->flags & IO_NONBLOCKING) {
-      if((UART_REG(uart_offset, UART_FR) & 0x20) != 0) {
-        if(i == 0) return -IO_EWOULDBLOCK;
-        else return i;
+  uint32_t written = 0;
+
+  for(uint32_t j = 0; j < num; ++j) {
+    const uint8_t *b_data = iov[j].base;
+    for(uint32_t i = 0; i < iov[j].length; ++i) {
+      // we cannot write if TXFF is 1
+      if(io->flags & IO_NONBLOCKING) {
+        if((UART_REG(uart_offset, UART_FR) & 0x20) != 0) {
+          if(written == 0) return -IO_EWOULDBLOCK;
+          else return written;
+        }
       }
+      else
+        while((UART_REG(uart_offset, UART_FR) & 0x20) != 0)
+          uart_sleep(io->channel, 0x20);
+      UART_REG(uart_offset, UART_DR) = b_data[i];
+      ++written;
     }
-    else
-      while((UART_REG(uart_offset, UART_FR) & 0x20) != 0);
-    UART_REG(uart_offset, UART_DR) = b_data[i];
   }
-  return length;
+  return written;
+}
+
+//------------------------------------------------------------------------------
+// Write to given UART
+//------------------------------------------------------------------------------
+static int32_t uart_write_normal(IO_io *io, const void *data, uint32_t length)
+{
+  IO_iovec iov = {data, length};
+  return uart_writev_normal(io, &iov, 1);
 }
 
 //------------------------------------------------------------------------------
@@ -137,7 +284,8 @@ static int32_t uart_read_normal(IO_io *io, void *data, uint32_t length)
       }
     }
     else
-      while((UART_REG(uart_offset, UART_FR) & 0x10) != 0);
+      while((UART_REG(uart_offset, UART_FR) & 0x10) != 0)
+        uart_sleep(io->channel, 0x50);  // RX or RX time-out
     b_data[i] = UART_REG(uart_offset, UART_DR) & 0xff;
   }
   return length;
@@ -151,38 +299,51 @@ static int32_t uart_write_dma(IO_io *io, const void *data, uint32_t length)
   uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
   uint8_t dma_channel = uart_info[io->channel].dma_channel_tx;
   uint8_t dma_enc = uart_info[io->channel].dma_channel_enc;
-  dma_control *ctrl = TM4C_dma_get_control(dma_channel, DMA_TYPE_PRIMARY);
 
   //----------------------------------------------------------------------------
-  // Check whether the DMA channel is ready for a transfer
+  // Wait for a free slot in the queue of the DMA channel
   //----------------------------------------------------------------------------
-  if(io->flags & IO_NONBLOCKING) {
-    if(ctrl->control & 0x03)
-      return -IO_EWOULDBLOCK;
-  }
-  else
-    while(ctrl->control & 0x03);
+  int32_t ret = TM4C_dma_wait_queue(dma_channel, DMA_MAX_IN_FLIGHT-1,
+                                    io->flags & IO_NONBLOCKING);
+  if(ret)
+    return ret;
 
   //----------------------------------------------------------------------------
-  // Set the channel control up
+  // Set the transfer up; it starts as soon as the previous ones are done and
+  // long buffers are split into scatter-gather tasks
   //----------------------------------------------------------------------------
   if(length == 0)
     return 0;
 
-  if(length > 1024)
-    length = 1024;
+  uint32_t control = 0;
+  control |= (0x03 << 30);      // destination does not increment
+  control |= (0x03 << 14);      // arbitration size is 8 transfers ==
+                                // interrupt trigger level for FIFO
 
-  ctrl->src = ((char *)data)+(length-1); // last byte of the buffer
-  ctrl->dst = (void *)&UART_REG(uart_offset, UART_DR);
-  ctrl->control = 0;
-  ctrl->control |= (0x03 << 30);      // destination does not increment
-  ctrl->control |= (0x03 << 14);      // arbitration size is 8 transfers ==
-                                      // interrupt trigger level for FIFO
-  ctrl->control |= ((length-1) << 4); // transfer size, up to 1024 bytes
-  ctrl->control |= 0x01;              // basic transfer mode
+  return TM4C_dma_transfer(dma_channel, dma_enc, data,
+                           (void *)&UART_REG(uart_offset, UART_DR), control,
+                           length);
+}
 
-  TM4C_dma_run_transfer(dma_channel, dma_enc);
-  return length;
+//------------------------------------------------------------------------------
+// Gather a list of buffers to UART in one DMA chain
+//------------------------------------------------------------------------------
+static int32_t uart_writev_dma(IO_io *io, const IO_iovec *iov, uint32_t num)
+{
+  uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
+  uint8_t dma_channel = uart_info[io->channel].dma_channel_tx;
+  uint8_t dma_enc = uart_info[io->channel].dma_channel_enc;
+
+  int32_t ret = TM4C_dma_wait(dma_channel, io->flags & IO_NONBLOCKING);
+  if(ret)
+    return ret;
+
+  uint32_t control = 0;
+  control |= (0x03 << 30);      // destination does not increment
+  control |= (0x03 << 14);      // arbitration size is 8 transfers
+
+  return TM4C_dma_gather(dma_channel, dma_enc, iov, num,
+                         (void *)&UART_REG(uart_offset, UART_DR), control);
 }
 
 //------------------------------------------------------------------------------
@@ -193,38 +354,92 @@ static int32_t uart_read_dma(IO_io *io, void *data, uint32_t length)
   uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
   uint8_t dma_channel = uart_info[io->channel].dma_channel_rx;
   uint8_t dma_enc = uart_info[io->channel].dma_channel_enc;
-  dma_control *ctrl = TM4C_dma_get_control(dma_channel, DMA_TYPE_PRIMARY);
 
   //----------------------------------------------------------------------------
-  // Check whether the DMA channel is ready for a transfer
+  // Wait for a free slot in the queue of the DMA channel
   //----------------------------------------------------------------------------
-  if(io->flags & IO_NONBLOCKING) {
-    if(ctrl->control & 0x03)
-      return -IO_EWOULDBLOCK;
-  }
-  else
-    while(ctrl->control & 0x03);
+  int32_t ret = TM4C_dma_wait_queue(dma_channel, DMA_MAX_IN_FLIGHT-1,
+                                    io->flags & IO_NONBLOCKING);
+  if(ret)
+    return ret;
 
   //----------------------------------------------------------------------------
-  // Set the channel control up
+  // Set the transfer up; it starts as soon as the previous ones are done and
+  // long buffers are split into scatter-gather tasks
   //----------------------------------------------------------------------------
   if(length == 0)
     return 0;
 
-  if(length > 1024)
-    length = 1024;
+  uint32_t control = 0;
+  control |= (0x03 << 26);      // source does not increment
+  control |= (0x03 << 14);      // arbitration size is 8 transfers ==
+                                // interrupt trigger level for FIFO
 
-  ctrl->src = (void *)&UART_REG(uart_offset, UART_DR);
-  ctrl->dst = ((char *)data)+(length-1); // last byte of the buffer
-  ctrl->control = 0;
-  ctrl->control |= (0x03 << 26);      // source does not increment
-  ctrl->control |= (0x03 << 14);      // arbitration size is 8 transfers ==
-                                      // interrupt trigger level for FIFO
-  ctrl->control |= ((length-1) << 4); // transfer size, up to 1024 bytes
-  ctrl->control |= 0x01;              // basic transfer mode
+  return TM4C_dma_transfer(dma_channel, dma_enc,
+                           (void *)&UART_REG(uart_offset, UART_DR), data,
+                           control, length);
+}
 
-  TM4C_dma_run_transfer(dma_channel, dma_enc);
-  return length;
+//------------------------------------------------------------------------------
+// Queue data for transmission
+//------------------------------------------------------------------------------
+static int32_t uart_write_buffered(IO_io *io, const void *data,
+  uint32_t length)
+{
+  uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
+  struct uart_ring *tx = &uart_buffers[io->channel]->tx;
+  const uint8_t *b_data = data;
+  uint32_t i = 0;
+
+  while(1) {
+    IO_disable_interrupts();
+    for(; i < length && tx->count < tx->size; ++i)
+      ring_push(tx, b_data[i]);
+    uart_tx_fill(uart_offset, tx);
+    if(i == length || (io->flags & IO_NONBLOCKING)) {
+      IO_enable_interrupts();
+      break;
+    }
+    // the interrupt drains the ring; we sleep on it if we can
+    if(!IO_sys_can_block()) {
+      IO_enable_interrupts();
+      continue;
+    }
+    IO_sys_completion_wait(&tx->done);
+  }
+
+  if(!i && length)
+    return -IO_EWOULDBLOCK;
+  return i;
+}
+
+//------------------------------------------------------------------------------
+// Read the received data
+//------------------------------------------------------------------------------
+static int32_t uart_read_buffered(IO_io *io, void *data, uint32_t length)
+{
+  struct uart_ring *rx = &uart_buffers[io->channel]->rx;
+  uint8_t *b_data = data;
+  uint32_t i = 0;
+
+  while(1) {
+    IO_disable_interrupts();
+    for(; i < length && rx->count; ++i)
+      b_data[i] = ring_pop(rx);
+    if(i == length || (io->flags & IO_NONBLOCKING)) {
+      IO_enable_interrupts();
+      break;
+    }
+    if(!IO_sys_can_block()) {
+      IO_enable_interrupts();
+      continue;
+    }
+    IO_sys_completion_wait(&rx->done);
+  }
+
+  if(!i && length)
+    return -IO_EWOULDBLOCK;
+  return i;
 }
 
 //------------------------------------------------------------------------------
@@ -233,16 +448,95 @@ static int32_t uart_read_dma(IO_io *io, void *data, uint32_t length)
 static int32_t uart_sync(IO_io *io)
 {
   uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
-  // the UART busy bit is set until all complete bytes, including the stop bits
-  // have been transmitted
-  while(UART_REG(uart_offset, UART_FR) & 0x08);
+
+  //----------------------------------------------------------------------------
+  // The DMA needs to move everything it has queued to the FIFO first
+  //----------------------------------------------------------------------------
+  if(io->flags & IO_DMA)
+    TM4C_dma_wait(uart_info[io->channel].dma_channel_tx, 0);
+
+  //----------------------------------------------------------------------------
+  // Whatever is still queued needs to reach the hardware first
+  //----------------------------------------------------------------------------
+  if(io->flags & IO_BUFFERED) {
+    struct uart_ring *tx = &uart_buffers[io->channel]->tx;
+    while(tx->count) {
+      if(!IO_sys_can_block())
+        continue;
+      IO_disable_interrupts();
+      if(!tx->count) {
+        IO_enable_interrupts();
+        break;
+      }
+      IO_sys_completion_wait(&tx->done);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // The UART busy bit is set until all complete bytes, including the stop
+  // bits have been transmitted. The TX interrupt is needed at the FIFO
+  // level by the buffered mode and the DMA, so we cannot have it signal the
+  // end of transmission; we sleep for a tick while the FIFO holds data and
+  // spin for the last byte only.
+  //----------------------------------------------------------------------------
+  while(UART_REG(uart_offset, UART_FR) & 0x08)
+    if(!(UART_REG(uart_offset, UART_FR) & 0x80) && IO_sys_can_block())
+      IO_sys_sleep(1);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Enable events on UART device
+//------------------------------------------------------------------------------
+static int32_t uart_event_enable(IO_io *io, uint16_t events)
+{
+  uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
+  uint32_t im = 0;
+  if(events & IO_EVENT_READ)  im |= 0x10;
+  if(events & IO_EVENT_WRITE) im |= 0x20;
+  IO_disable_interrupts();
+  uart_waiters[io->channel].user |= im;
+  UART_REG(uart_offset, UART_IM) |= im;
+  IO_enable_interrupts();
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Disable events on UART device
+//------------------------------------------------------------------------------
+static int32_t uart_event_disable(IO_io *io, uint16_t events)
+{
+  uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
+  uint32_t im = 0;
+  if(events & IO_EVENT_READ)  im |= 0x10;
+  if(events & IO_EVENT_WRITE) im |= 0x20;
+  IO_disable_interrupts();
+  uart_waiters[io->channel].user &= ~im;
+  UART_REG(uart_offset, UART_IM) &= ~(im & ~uart_waiters[io->channel].mask);
+  IO_enable_interrupts();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Device operations; the buffered mode delivers no events, its interrupt
+// serves the rings
+//------------------------------------------------------------------------------
+static const IO_ops uart_ops_normal = {
+  uart_write_normal, uart_writev_normal, uart_read_normal, uart_sync,
+  uart_event_enable, uart_event_disable };
+
+static const IO_ops uart_ops_dma = {
+  uart_write_dma, uart_writev_dma, uart_read_dma, uart_sync,
+  uart_event_enable, uart_event_disable };
+
+static const IO_ops uart_ops_buffered = {
+  uart_write_buffered, 0, uart_read_buffered, uart_sync, 0, 0 };
+
 //------------------------------------------------------------------------------
 // Initialize given UART module
 //------------------------------------------------------------------------------
-int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud)
+static int32_t uart_init(IO_io *io, uint8_t module, uint16_t flags,
+  uint32_t baud)
 {
   if(module > 7)
     return -IO_EINVAL;
@@ -276,10 +570,11 @@ int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud)
   //----------------------------------------------------------------------------
   // Configure UART
   //----------------------------------------------------------------------------
-  // calculate the desired baud rate
-  float brd = ((float)80000000) / (16.0 * baud);
-  unsigned long ibrd = (int)brd;
-  unsigned long fbrd = (int)((brd-ibrd) * 64.0 + 0.5);
+  // calculate the desired baud rate divisor, 80MHz/(16*baud), in 1/64ths
+  // rounded to the nearest
+  uint32_t brd  = ((8 * 80000000) / baud + 1) / 2;
+  uint32_t ibrd = brd >> 6;
+  uint32_t fbrd = brd & 0x3f;
 
   // disable uart
   UART_REG(uart_offset, UART_CTL) &= ~0x01;
@@ -291,8 +586,13 @@ int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud)
   // no parity, 8-bits, FIFOs
   UART_REG(uart_offset, UART_LCRH) = 0x00000070;
 
-  if(flags & IO_DMA)
+  if(flags & IO_DMA) {
+    uint8_t enc = uart_info[module].dma_channel_enc;
+    if(TM4C_dma_channel_alloc(uart_info[module].dma_channel_rx, enc, 0, 0) ||
+       TM4C_dma_channel_alloc(uart_info[module].dma_channel_tx, enc, 0, 0))
+      return -IO_EBUSY;
     UART_REG(uart_offset, UART_DMACTL) |= 0x03;
+  }
 
   // enable uart
   UART_REG(uart_offset, UART_CTL) |= 0x01;
@@ -304,48 +604,89 @@ int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud)
   io->flags = flags;
   io->type = IO_UART;
   io->event = 0;
-  io->sync = uart_sync;
-  uart_devices[module] = io;
+  if(flags & IO_BUFFERED)
+    io->ops = &uart_ops_buffered;
+  else if(flags & IO_DMA)
+    io->ops = &uart_ops_dma;
+  else
+    io->ops = &uart_ops_normal;
+  TM4C_device_register(TM4C_DEV_UART + module, io);
+  uart_waiters[module].mask = 0;
+  uart_waiters[module].user = 0;
+  IO_sys_completion_init(&uart_waiters[module].done);
 
   //----------------------------------------------------------------------------
-  // Normal read/write
+  // Enable the interrupt; the buffered mode needs it to receive and to drain
+  // the TX buffer, the other modes for the events, the DMA completions and to
+  // wake up the blocked threads
   //----------------------------------------------------------------------------
-  if(!(flags & IO_DMA)) {
-    io->write = uart_write_normal;
-    io->read = uart_read_normal;
-  }
-  else {
-    io->write = uart_write_dma;
-    io->read = uart_read_dma;
-  }
+  if(flags & IO_BUFFERED)
+    UART_REG(uart_offset, UART_IM) = 0x50; // RX and RX timeout
 
-  //----------------------------------------------------------------------------
-  // Enable the interrupt if needed
-  //----------------------------------------------------------------------------
-  if(flags & IO_ASYNC)
-    TM4C_enable_interrupt(uart_info[module].interrupt_num, 7);
+  TM4C_enable_interrupt(uart_info[module].interrupt_num, 7);
 
   return 0;
 }
 
 //------------------------------------------------------------------------------
-// Enable events on UART device
+// Initialize given UART module
 //------------------------------------------------------------------------------
-int32_t TM4C_uart_event_enable(IO_io *io, uint16_t events)
+int32_t IO_uart_init(IO_io *io, uint8_t module, uint16_t flags, uint32_t baud)
 {
-  uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
-  if(events & IO_EVENT_READ)  UART_REG(uart_offset, UART_IM) |= 0x10;
-  if(events & IO_EVENT_WRITE) UART_REG(uart_offset, UART_IM) |= 0x20;
-  return 0;
+  if(flags & IO_BUFFERED)
+    return IO_uart_init_buffered(io, module, flags, baud, UART_TX_BUFFER,
+                                 UART_RX_BUFFER);
+  return uart_init(io, module, flags, baud);
 }
 
 //------------------------------------------------------------------------------
-// Disable events on UART device
+// Initialize given UART module in the buffered mode
 //------------------------------------------------------------------------------
-int32_t TM4C_uart_event_disable(IO_io *io, uint16_t events)
+int32_t IO_uart_init_buffered(IO_io *io, uint8_t module, uint16_t flags,
+  uint32_t baud, uint16_t tx_size, uint16_t rx_size)
 {
-  uint32_t uart_offset = io->channel*UART_MODULE_OFFSET;
-  if(events & IO_EVENT_READ)  UART_REG(uart_offset, UART_IM) &= ~0x10;
-  if(events & IO_EVENT_WRITE) UART_REG(uart_offset, UART_IM) &= ~0x20;
-  return 0;
+  if(module > 7 || !io || !tx_size || !rx_size || (flags & IO_DMA))
+    return -IO_EINVAL;
+
+  //----------------------------------------------------------------------------
+  // Set up the rings; a buffered init done before may still be taking the
+  // interrupts, so they are masked until uart_init unmasks them again
+  //----------------------------------------------------------------------------
+  uint32_t uart_offset = module * UART_MODULE_OFFSET;
+  IO_io *old = TM4C_device(TM4C_DEV_UART + module);
+  if(old && (old->flags & IO_BUFFERED))
+    UART_REG(uart_offset, UART_IM) = 0;
+
+  struct uart_buffers *buf = uart_buffers[module];
+  if(buf) {
+    if(buf->tx.data)
+      IO_free(buf->tx.data);
+    if(buf->rx.data)
+      IO_free(buf->rx.data);
+  }
+  else {
+    buf = IO_malloc(sizeof(struct uart_buffers));
+    if(!buf)
+      return -IO_ENOMEM;
+    uart_buffers[module] = buf;
+  }
+
+  memset(buf, 0, sizeof(struct uart_buffers));
+  buf->tx.data = IO_malloc(tx_size);
+  buf->rx.data = IO_malloc(rx_size);
+  if(!buf->tx.data || !buf->rx.data) {
+    IO_free(buf->tx.data);
+    IO_free(buf->rx.data);
+    buf->tx.data = 0;
+    buf->rx.data = 0;
+    if(old && (old->flags & IO_BUFFERED))
+      TM4C_device_register(TM4C_DEV_UART + module, 0);
+    return -IO_ENOMEM;
+  }
+  buf->tx.size = tx_size;
+  buf->rx.size = rx_size;
+  IO_sys_completion_init(&buf->tx.done);
+  IO_sys_completion_init(&buf->rx.done);
+
+  return uart_init(io, module, flags | IO_BUFFERED, baud);
 }